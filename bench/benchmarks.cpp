@@ -0,0 +1,257 @@
+// Google Benchmark suite for the generator and solver hot paths.
+//
+// Every input comes from a fixed seed, so runs before and after a change
+// measure the same dungeons, and every solver strategy sees the same
+// inputs. Solver inputs are generated once and cached outside the timed
+// loops. Counters:
+//   time/cell  wall time per dungeon cell (size x size)
+//   nodes/s    search states expanded per second: SolverStats::popped of
+//              one instrumented solve of the input (left out when the key
+//              graph solver takes the map, since it does not count states)
+//   peak_mem   peak heap bytes live during the timed loop, above what was
+//              live before it
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <map>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "generator.h"
+#include "solver.h"
+#include "solver_stats.h"
+#include "grid_layout.h"
+#include "huge_pages.h"
+
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Heap accounting: every allocation carries its size in a header in front
+// of the block. The aligned forms matter too: the default memory resource,
+// and so every pmr solver buffer, allocates through them.
+
+static atomic<size_t> liveBytes(0), peakBytes(0);
+
+// malloc/free behind operator new/delete is the point here
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static void* countedAlloc(size_t size, size_t align) {
+    size_t header = max(align, alignof(max_align_t));
+    size_t total = (size + header + align - 1) / align * align;
+    void* block = align > alignof(max_align_t) ? aligned_alloc(align, total) : malloc(total);
+    if (!block) throw bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    size_t live = liveBytes.fetch_add(size, memory_order_relaxed) + size;
+    size_t peak = peakBytes.load(memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+    }
+    return static_cast<char*>(block) + header;
+}
+
+static void countedFree(void* pointer, size_t align) {
+    if (!pointer) return;
+    char* block = static_cast<char*>(pointer) - max(align, alignof(max_align_t));
+    liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), memory_order_relaxed);
+    free(block);
+}
+
+void* operator new(size_t size) { return countedAlloc(size, alignof(max_align_t)); }
+void* operator new(size_t size, align_val_t align) { return countedAlloc(size, static_cast<size_t>(align)); }
+void operator delete(void* pointer) noexcept { countedFree(pointer, alignof(max_align_t)); }
+void operator delete(void* pointer, size_t) noexcept { countedFree(pointer, alignof(max_align_t)); }
+void operator delete(void* pointer, align_val_t align) noexcept {
+    countedFree(pointer, static_cast<size_t>(align));
+}
+void operator delete(void* pointer, size_t, align_val_t align) noexcept {
+    countedFree(pointer, static_cast<size_t>(align));
+}
+
+// Peak heap growth between construction and report()
+class PeakMemory {
+public:
+    PeakMemory() : base_(liveBytes.load()) { peakBytes.store(base_); }
+
+    void report(benchmark::State& state) const {
+        double peak = static_cast<double>(peakBytes.load() - base_);
+        state.counters["peak_mem"] = benchmark::Counter(peak, benchmark::Counter::kDefaults,
+                                                        benchmark::Counter::kIs1024);
+    }
+
+private:
+    size_t base_;
+};
+
+// ---------------------------------------------------------------------------
+// Inputs
+
+const vector<int64_t> SIZES = {31, 101, 501, 2001, 8001};
+const vector<int64_t> KEY_SIZES = {31, 101, 501, 2001};  // 2^keys layers: 8001 is too large
+const vector<int64_t> ROOM_RATES = {0, 20};
+const vector<int64_t> KEY_COUNTS = {1, 3, 5};
+const vector<int64_t> LAYOUT_SIZES = {2001, 4001, 8001};  // around TILED_LAYOUT_MIN_TILES
+
+static GeneratorOptions inputOptions(int size, int roomRate, int keys) {
+    GeneratorOptions options;
+    options.seed = 0xD0C5EEDull + static_cast<uint64_t>(size) * 1000 + roomRate * 10 + keys;
+    options.roomRate = roomRate;
+    options.keys = keys;
+    options.requiredKeys = keys;
+    return options;
+}
+
+// A size x size dungeon, generated on first use and kept for the whole run
+static const Grid& input(int size, int roomRate, int keys) {
+    static map<tuple<int, int, int>, Grid> cache;
+    auto key = make_tuple(size, roomRate, keys);
+    auto found = cache.find(key);
+    if (found == cache.end()) {
+        found = cache.emplace(key, generateDungeonGrid(size, size, inputOptions(size, roomRate, keys))).first;
+    }
+    return found->second;
+}
+
+static void setCounters(benchmark::State& state, int size, double nodes, const PeakMemory& memory) {
+    double cells = static_cast<double>(size) * size;
+    state.counters["time/cell"] = benchmark::Counter(
+        cells, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    if (nodes > 0) {
+        state.counters["nodes/s"] = benchmark::Counter(nodes, benchmark::Counter::kIsIterationInvariantRate);
+    }
+    memory.report(state);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+
+// Args: size, roomRate
+static void BM_GenerateDungeon(benchmark::State& state) {
+    int size = static_cast<int>(state.range(0));
+    GeneratorOptions options = inputOptions(size, static_cast<int>(state.range(1)), 0);
+    PeakMemory memory;
+    for (auto _ : state) {
+        vector<string> dungeon = generateDungeon(size, size, options);
+        benchmark::DoNotOptimize(dungeon.data());
+    }
+    setCounters(state, size, 0, memory);
+}
+
+// Args: size, roomRate; one registration per strategy
+static void BM_BfsPath(benchmark::State& state, SolverStrategy strategy) {
+    int size = static_cast<int>(state.range(0));
+    const Grid& dungeon = input(size, static_cast<int>(state.range(1)), 0);
+    SolverStats stats;
+    bfsPath(dungeon, strategy, stats);
+    double nodes = static_cast<double>(stats.popped);
+    PeakMemory memory;
+    for (auto _ : state) {
+        vector<Cell> path = bfsPath(dungeon, strategy);
+        benchmark::DoNotOptimize(path.data());
+    }
+    setCounters(state, size, nodes, memory);
+}
+
+// Args: size, roomRate; one registration per layout, plus Auto on huge pages
+static void BM_BfsPathLayout(benchmark::State& state, GridLayout layout, bool hugePages) {
+    int size = static_cast<int>(state.range(0));
+    const Grid& dungeon = input(size, static_cast<int>(state.range(1)), 0);
+    SolverStats stats;
+    bfsPath(dungeon, stats);
+    double nodes = static_cast<double>(stats.popped);
+    PeakMemory memory;
+    for (auto _ : state) {
+        if (hugePages) {
+            pmr::vector<Cell> path = bfsPath(dungeon, hugePageResource());
+            benchmark::DoNotOptimize(path.data());
+        } else {
+            vector<Cell> path = bfsPath(dungeon, layout);
+            benchmark::DoNotOptimize(path.data());
+        }
+    }
+    setCounters(state, size, nodes, memory);
+}
+
+// Args: size, roomRate, keys
+static void BM_BfsPathKeys(benchmark::State& state) {
+    int size = static_cast<int>(state.range(0));
+    const Grid& dungeon = input(size, static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+    SolverStats stats;
+    bfsPathKeys(dungeon, stats);
+    double nodes = static_cast<double>(stats.popped);
+    PeakMemory memory;
+    for (auto _ : state) {
+        vector<Cell> path = bfsPathKeys(dungeon);
+        benchmark::DoNotOptimize(path.data());
+    }
+    setCounters(state, size, nodes, memory);
+}
+
+#ifdef IMPLEMENT_OPTIONAL_FUNCTIONS
+// Args: size, roomRate, keys
+static void BM_CountReachableKeys(benchmark::State& state) {
+    int size = static_cast<int>(state.range(0));
+    const Grid& dungeon = input(size, static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+    PeakMemory memory;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(countReachableKeys(dungeon));
+    }
+    setCounters(state, size, 0, memory);
+}
+#endif
+
+static void registerBenchmarks() {
+    benchmark::RegisterBenchmark("BM_GenerateDungeon", BM_GenerateDungeon)
+        ->ArgNames({"size", "roomRate"})
+        ->ArgsProduct({SIZES, ROOM_RATES})
+        ->Unit(benchmark::kMicrosecond);
+
+    const pair<const char*, SolverStrategy> strategies[] = {
+        {"Standard", SolverStrategy::Standard},     {"Bidirectional", SolverStrategy::Bidirectional},
+        {"BitParallel", SolverStrategy::BitParallel}, {"Parallel", SolverStrategy::Parallel},
+        {"AStar", SolverStrategy::AStar},           {"JumpPoint", SolverStrategy::JumpPoint}};
+    for (const auto& strategy : strategies) {
+        benchmark::RegisterBenchmark((string("BM_BfsPath/") + strategy.first).c_str(), BM_BfsPath,
+                                     strategy.second)
+            ->ArgNames({"size", "roomRate"})
+            ->ArgsProduct({SIZES, ROOM_RATES})
+            ->Unit(benchmark::kMicrosecond);
+    }
+
+    const tuple<const char*, GridLayout, bool> layouts[] = {
+        {"RowMajor", GridLayout::RowMajor, false}, {"Tiled", GridLayout::Tiled, false},
+        {"AutoHugePages", GridLayout::Auto, true}};
+    for (const auto& layout : layouts) {
+        benchmark::RegisterBenchmark((string("BM_BfsPathLayout/") + get<0>(layout)).c_str(), BM_BfsPathLayout,
+                                     get<1>(layout), get<2>(layout))
+            ->ArgNames({"size", "roomRate"})
+            ->ArgsProduct({LAYOUT_SIZES, ROOM_RATES})
+            ->Unit(benchmark::kMicrosecond);
+    }
+
+    benchmark::RegisterBenchmark("BM_BfsPathKeys", BM_BfsPathKeys)
+        ->ArgNames({"size", "roomRate", "keys"})
+        ->ArgsProduct({KEY_SIZES, ROOM_RATES, KEY_COUNTS})
+        ->Unit(benchmark::kMicrosecond);
+
+#ifdef IMPLEMENT_OPTIONAL_FUNCTIONS
+    benchmark::RegisterBenchmark("BM_CountReachableKeys", BM_CountReachableKeys)
+        ->ArgNames({"size", "roomRate", "keys"})
+        ->ArgsProduct({KEY_SIZES, ROOM_RATES, KEY_COUNTS})
+        ->Unit(benchmark::kMicrosecond);
+#endif
+}
+
+int main(int argc, char** argv) {
+    registerBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
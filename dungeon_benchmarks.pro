@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = dungeon_benchmarks
+QT -= gui
+CONFIG += console c++17 silent thread release
+CONFIG -= app_bundle
+INCLUDEPATH += src
+SOURCES += $$files(src/*.cpp) \
+           bench/benchmarks.cpp
+SOURCES -= src/main.cpp
+HEADERS += $$files(src/*.h)
+LIBS += -lbenchmark
+
+OTHER_FILES += \
+    README.md
@@ -1,13 +1,55 @@
 TEMPLATE = app
 QT -= gui
-CONFIG += console c++17 silent
+CONFIG += console c++17 silent thread
 CONFIG -= app_bundle
 SOURCES += src/main.cpp \
+           src/astar.cpp \
+           src/batch_solver.cpp \
+           src/bitbfs.cpp \
+           src/distance_field.cpp \
+           src/dungeon_io.cpp \
            src/generator.cpp \
-           src/solver.cpp
-HEADERS += src/cell.h \
+           src/incremental.cpp \
+           src/grid.cpp \
+           src/grid_layout.cpp \
+           src/hpa.cpp \
+           src/huge_pages.cpp \
+           src/key_placement.cpp \
+           src/keygraph.cpp \
+           src/level_index.cpp \
+           src/packed_dungeon.cpp \
+           src/parallel_bfs.cpp \
+           src/solve_service.cpp \
+           src/solver.cpp \
+           src/solver_stats.cpp \
+           src/thread_pool.cpp \
+           src/tiles.cpp
+HEADERS += src/astar.h \
+           src/batch_solver.h \
+           src/bfs_kernel.h \
+           src/bitbfs.h \
+           src/cell.h \
+           src/dense.h \
+           src/distance_field.h \
+           src/dungeon_io.h \
            src/generator.h \
-           src/solver.h
+           src/incremental.h \
+           src/grid.h \
+           src/grid_layout.h \
+           src/hpa.h \
+           src/huge_pages.h \
+           src/key_placement.h \
+           src/keygraph.h \
+           src/level_index.h \
+           src/maze_algorithms.h \
+           src/packed_dungeon.h \
+           src/parallel_bfs.h \
+           src/rng.h \
+           src/solve_service.h \
+           src/solver.h \
+           src/solver_stats.h \
+           src/thread_pool.h \
+           src/tiles.h
 
 OTHER_FILES += \
     README.md \
@@ -0,0 +1,372 @@
+/**
+ * Dungeon Pathfinder - Heuristic Search
+ *
+ * A* with a two-stack bucket queue, Jump Point Search and key-layer A*.
+ */
+
+#include "astar.h"
+#include "dense.h"
+#include "tiles.h"
+#include "level_index.h"
+#include "solver.h"
+#include "solver_stats.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+using namespace std;
+
+
+// Whether each direction (see DIRECTIONS) moves from (row, col) toward the
+// goal, i.e. lowers the Manhattan distance by one
+static void closerDirections(int row, int col, int goalRow, int goalCol, bool closer[NUM_DIRECTIONS]) {
+    closer[0] = row > goalRow;
+    closer[1] = row < goalRow;
+    closer[2] = col > goalCol;
+    closer[3] = col < goalCol;
+}
+
+template <typename Stats>
+static vector<Cell> astarSearch(const Grid& dungeon, Stats& stats) {
+    int startIdx = dungeon.find('S');
+    int goalIdx = dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+
+    const int goalRow = dungeon.row(goalIdx), goalCol = dungeon.col(goalIdx);
+    BitSet closed(dungeon.size());
+    PackedArray<2> parentDir(dungeon.size());
+
+    // Open list: current holds nodes with f == bound, next those with
+    // f == bound + 2. A move toward E keeps f, any other move adds 2.
+    struct Entry {
+        int cell;
+        uint8_t dir;  // direction taken to enter the cell
+    };
+    vector<Entry> current{{startIdx, 0}}, next;
+    int bound = abs(dungeon.row(startIdx) - goalRow) + abs(dungeon.col(startIdx) - goalCol);
+    auto account = [&] {
+        stats.allocated(closed.bytes() + parentDir.bytes() + capacityBytes(current) + capacityBytes(next));
+    };
+    stats.layers(1);
+    stats.push();
+
+    while (true) {
+        if (current.empty()) {
+            if (next.empty()) {
+                account();
+                return {};
+            }
+            current.swap(next);
+            bound += 2;
+        }
+        Entry entry = current.back();
+        current.pop_back();
+        stats.pop();
+        if (closed.testAndSet(entry.cell)) continue;
+        parentDir.set(entry.cell, entry.dir);
+        stats.visit(0);
+
+        if (entry.cell == goalIdx) {
+            // h(E) = 0, so the path has bound moves
+            account();
+            stats.phase(SolvePhase::Reconstruct);
+            vector<Cell> path(bound + 1);
+            int cur = goalIdx;
+            for (int step = bound; step > 0; step--) {
+                path[step] = dungeon.cellAt(cur);
+                cur -= dungeon.offset(parentDir.get(cur));
+            }
+            path[0] = dungeon.cellAt(startIdx);
+            return path;
+        }
+
+        bool closer[NUM_DIRECTIONS];
+        closerDirections(dungeon.row(entry.cell), dungeon.col(entry.cell), goalRow, goalCol, closer);
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int n = entry.cell + dungeon.offset(d);
+            if (blocksWithoutKeys(dungeon[n]) || closed.test(n)) continue;
+            (closer[d] ? current : next).push_back({n, static_cast<uint8_t>(d)});
+            stats.push();
+        }
+        stats.frontier(current.size() + next.size());
+    }
+}
+
+vector<Cell> astarPath(const Grid& dungeon) {
+    NoStats stats;
+    return astarSearch(dungeon, stats);
+}
+
+vector<Cell> astarPath(const Grid& dungeon, SolverStats& stats) {
+    StatsRecorder recorder(stats);
+    return astarSearch(dungeon, recorder);
+}
+
+vector<Cell> astarPath(const vector<string>& dungeon) {
+    return astarPath(Grid::fromStrings(dungeon));
+}
+
+// Jump Point Search on a 4-connected grid. Canonical paths move
+// horizontally first: a horizontal run may turn vertical at any cell, a
+// vertical run only turns where a side cell opens up past a blocked one.
+// A jump scans a straight run and returns the first cell where the search
+// must branch (or E), or -1 if it ends in a wall.
+class JumpSearch {
+public:
+    JumpSearch(const Grid& dungeon, int goalIdx) : grid_(dungeon), goal_(goalIdx) {}
+
+    bool blocked(int idx) const { return blocksWithoutKeys(grid_[idx]); }
+
+    // Vertical run; step is +-stride
+    int jumpVertical(int idx, int step) const {
+        while (true) {
+            idx += step;
+            if (blocked(idx)) return -1;
+            if (idx == goal_ || forced(idx, step)) return idx;
+        }
+    }
+
+    // Horizontal run; step is +-1. Every cell probes both vertical runs.
+    int jumpHorizontal(int idx, int step) const {
+        const int stride = grid_.stride();
+        while (true) {
+            idx += step;
+            if (blocked(idx)) return -1;
+            if (idx == goal_) return idx;
+            if (jumpVertical(idx, stride) != -1 || jumpVertical(idx, -stride) != -1) return idx;
+        }
+    }
+
+    // A side cell reachable from a vertical run, but not from the cell behind it
+    bool forced(int idx, int step) const {
+        return (!blocked(idx - 1) && blocked(idx - step - 1)) ||
+               (!blocked(idx + 1) && blocked(idx - step + 1));
+    }
+
+private:
+    const Grid& grid_;
+    int goal_;
+};
+
+template <typename Stats>
+static vector<Cell> jpsSearch(const Grid& dungeon, Stats& stats) {
+    int startIdx = dungeon.find('S');
+    int goalIdx = dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+
+    const int stride = dungeon.stride();
+    const int goalRow = dungeon.row(goalIdx), goalCol = dungeon.col(goalIdx);
+    auto heuristic = [&](int idx) {
+        return abs(dungeon.row(idx) - goalRow) + abs(dungeon.col(idx) - goalCol);
+    };
+
+    const uint32_t UNSEEN = 0xFFFFFFFFu;
+    vector<uint32_t> g(dungeon.size(), UNSEEN);
+    vector<int> parent(dungeon.size(), -1);  // previous jump point
+    BitSet closed(dungeon.size());
+    JumpSearch jumps(dungeon, goalIdx);
+
+    // Bucket queue over f. Every move changes f by 0 or 2, so all f values
+    // share the parity of h(S) and bucket i holds f = h(S) + 2i.
+    const int baseF = heuristic(startIdx);
+    vector<vector<int>> buckets(1, vector<int>{startIdx});
+    g[startIdx] = 0;
+    uint64_t queued = 1;  // entries in all buckets, for the frontier statistic
+    auto account = [&] {
+        uint64_t bytes = capacityBytes(g) + capacityBytes(parent) + closed.bytes() + capacityBytes(buckets);
+        for (const vector<int>& bucket : buckets) bytes += capacityBytes(bucket);
+        stats.allocated(bytes);
+    };
+    stats.layers(1);
+    stats.push();
+
+    auto relax = [&](int from, int to) {
+        if (to == -1 || closed.test(to)) return;
+        int length = dungeon.row(from) == dungeon.row(to) ? abs(to - from) : abs(to - from) / stride;
+        uint32_t cost = g[from] + length;
+        if (cost >= g[to]) return;
+        g[to] = cost;
+        parent[to] = from;
+        size_t bucket = (cost + heuristic(to) - baseF) / 2;
+        if (bucket >= buckets.size()) buckets.resize(bucket + 1);
+        buckets[bucket].push_back(to);
+        stats.push();
+        if constexpr (Stats::enabled) stats.frontier(++queued);
+    };
+
+    for (size_t b = 0; b < buckets.size(); b++) {
+        while (!buckets[b].empty()) {
+            int cur = buckets[b].back();
+            buckets[b].pop_back();
+            stats.pop();
+            if constexpr (Stats::enabled) queued--;
+            if (closed.testAndSet(cur)) continue;
+            stats.visit(0);
+
+            if (cur == goalIdx) {
+                // Unroll the straight segments between jump points
+                account();
+                stats.phase(SolvePhase::Reconstruct);
+                vector<Cell> path(g[goalIdx] + 1);
+                int step = static_cast<int>(g[goalIdx]);
+                for (int at = goalIdx; at != startIdx; ) {
+                    int from = parent[at];
+                    int delta = dungeon.row(from) == dungeon.row(at) ? (at > from ? 1 : -1)
+                                                                     : (at > from ? stride : -stride);
+                    for (; at != from; at -= delta) path[step--] = dungeon.cellAt(at);
+                }
+                path[0] = dungeon.cellAt(startIdx);
+                return path;
+            }
+
+            int from = parent[cur];
+            if (from == -1) {
+                // Start: search every direction
+                relax(cur, jumps.jumpHorizontal(cur, 1));
+                relax(cur, jumps.jumpHorizontal(cur, -1));
+                relax(cur, jumps.jumpVertical(cur, stride));
+                relax(cur, jumps.jumpVertical(cur, -stride));
+            } else if (dungeon.row(from) == dungeon.row(cur)) {
+                // Arrived horizontally: keep going, or turn either way
+                relax(cur, jumps.jumpHorizontal(cur, cur > from ? 1 : -1));
+                relax(cur, jumps.jumpVertical(cur, stride));
+                relax(cur, jumps.jumpVertical(cur, -stride));
+            } else {
+                // Arrived vertically: keep going; turn only to forced sides
+                int step = cur > from ? stride : -stride;
+                relax(cur, jumps.jumpVertical(cur, step));
+                for (int side = -1; side <= 1; side += 2) {
+                    if (!jumps.blocked(cur + side) && jumps.blocked(cur - step + side)) {
+                        relax(cur, jumps.jumpHorizontal(cur, side));
+                    }
+                }
+            }
+        }
+    }
+    account();
+    return {};
+}
+
+vector<Cell> jpsPath(const Grid& dungeon) {
+    NoStats stats;
+    return jpsSearch(dungeon, stats);
+}
+
+vector<Cell> jpsPath(const Grid& dungeon, SolverStats& stats) {
+    StatsRecorder recorder(stats);
+    return jpsSearch(dungeon, recorder);
+}
+
+vector<Cell> jpsPath(const vector<string>& dungeon) {
+    return jpsPath(Grid::fromStrings(dungeon));
+}
+
+// Parent record of a key-layer state: direction taken to enter the cell,
+// plus a flag when entering it picked up its key (as in bfsPathKeys)
+static const uint8_t PICKED_KEY = 4;
+
+template <typename Stats>
+static vector<Cell> astarSearchKeys(const Grid& dungeon, Stats& stats) {
+    LevelIndex level = indexLevel(dungeon);
+    int startIdx = level.start;
+    int goalIdx = level.goal;
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+
+    TileMap tiles(dungeon, level, DEFAULT_NUM_KEYS);
+    const uint64_t cells = static_cast<uint64_t>(dungeon.size());
+    BitSet closed(cells * tiles.numLayers());
+    PackedArray<4> parent(cells * tiles.numLayers());
+
+    // h depends on the cell only, so f still changes by 0 or 2 per move
+    // and the two-stack queue of astarPath carries over to key layers
+    const int goalRow = dungeon.row(goalIdx), goalCol = dungeon.col(goalIdx);
+    struct Entry {
+        uint64_t state;  // keys * cells + cell index
+        uint8_t record;
+    };
+    vector<Entry> current{{static_cast<uint64_t>(startIdx), 0}}, next;
+    int bound = abs(dungeon.row(startIdx) - goalRow) + abs(dungeon.col(startIdx) - goalCol);
+    auto account = [&] {
+        stats.allocated(closed.bytes() + parent.bytes() + capacityBytes(current) + capacityBytes(next));
+    };
+    stats.layers(tiles.numLayers());
+    stats.push();
+
+    while (true) {
+        if (current.empty()) {
+            if (next.empty()) {
+                account();
+                return {};
+            }
+            current.swap(next);
+            bound += 2;
+        }
+        Entry entry = current.back();
+        current.pop_back();
+        stats.pop();
+        if (closed.testAndSet(entry.state)) continue;
+        parent.set(entry.state, entry.record);
+
+        int idx = static_cast<int>(entry.state % cells);
+        uint64_t keys = entry.state / cells;
+        stats.visit(keys);
+        if (idx == goalIdx) {
+            account();
+            stats.phase(SolvePhase::Reconstruct);
+            vector<Cell> path(bound + 1);
+            uint64_t s = entry.state;
+            for (int step = bound; step > 0; step--) {
+                int sIdx = static_cast<int>(s % cells);
+                uint64_t sKeys = s / cells;
+                uint8_t rec = parent.get(s);
+                path[step] = dungeon.cellAt(sIdx);
+                if (rec & PICKED_KEY) sKeys ^= uint64_t(1) << (tiles[sIdx] & TILE_BIT_MASK);
+                s = sKeys * cells + (sIdx - dungeon.offset(rec & 3));
+            }
+            path[0] = dungeon.cellAt(startIdx);
+            return path;
+        }
+
+        bool closer[NUM_DIRECTIONS];
+        closerDirections(dungeon.row(idx), dungeon.col(idx), goalRow, goalCol, closer);
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int n = idx + dungeon.offset(d);
+            uint8_t tile = tiles[n];
+            if (tile == TILE_WALL) continue;
+
+            uint64_t newKeys = keys;
+            uint8_t record = static_cast<uint8_t>(d);
+            if (tile & TILE_DOOR) {
+                if (!((newKeys >> (tile & TILE_BIT_MASK)) & 1)) continue; // door locked
+            } else if (tile & TILE_KEY) {
+                uint64_t bit = uint64_t(1) << (tile & TILE_BIT_MASK);
+                if (!(newKeys & bit)) record |= PICKED_KEY;
+                newKeys |= bit;
+            }
+
+            uint64_t s = newKeys * cells + n;
+            if (closed.test(s)) continue;
+            (closer[d] ? current : next).push_back({s, record});
+            stats.push();
+        }
+        stats.frontier(current.size() + next.size());
+    }
+}
+
+vector<Cell> astarPathKeys(const Grid& dungeon) {
+    NoStats stats;
+    return astarSearchKeys(dungeon, stats);
+}
+
+vector<Cell> astarPathKeys(const Grid& dungeon, SolverStats& stats) {
+    StatsRecorder recorder(stats);
+    return astarSearchKeys(dungeon, recorder);
+}
+
+vector<Cell> astarPathKeys(const vector<string>& dungeon) {
+    return astarPathKeys(Grid::fromStrings(dungeon));
+}
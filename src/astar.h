@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "cell.h"
+#include "grid.h"
+#include "solver_stats.h"
+
+/**
+ * A* search for one S-to-E query with the Manhattan distance to E as the
+ * heuristic. On open-room dungeons it expands a narrow band around the
+ * straight line instead of BFS's whole diamond.
+ *
+ * Every move costs 1 and Manhattan distance changes by exactly 1 per move,
+ * so f = g + h either stays the same or grows by 2. The open list is
+ * therefore a bucket queue of just two stacks (f and f + 2); ties pop
+ * last-in first, which prefers the deepest node and runs straight across
+ * open rooms. No g values are stored: a node's g is f - h when it is
+ * popped. Same rules and path length as bfsPath (doors block).
+ * The SolverStats overload also records the search (see solver_stats.h).
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> astarPath(const std::vector<std::string>& dungeon);
+std::vector<Cell> astarPath(const Grid& dungeon);
+std::vector<Cell> astarPath(const Grid& dungeon, SolverStats& stats);
+
+/**
+ * Jump Point Search: A* over jump points only. Straight runs through open
+ * rooms are scanned without queuing their cells, so the many symmetric
+ * shortest paths of a room are never expanded. Uses the 4-connected
+ * pruning rules (horizontal moves branch vertically; vertical moves only
+ * turn at forced neighbors) and a bucket queue indexed by f. Same rules and
+ * path length as bfsPath. With only 4 neighbors every horizontal step still
+ * scans both vertical runs, so JPS saves queue operations rather than cell
+ * reads; in open rooms astarPath is usually faster.
+ * The SolverStats overload also records the search (see solver_stats.h).
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> jpsPath(const std::vector<std::string>& dungeon);
+std::vector<Cell> jpsPath(const Grid& dungeon);
+std::vector<Cell> jpsPath(const Grid& dungeon, SolverStats& stats);
+
+/**
+ * A* over the (keys, cell) state space of bfsPathKeys. Manhattan distance
+ * to E ignores doors and keys, so it stays admissible and consistent on
+ * every key layer, and the two-stack queue of astarPath still applies.
+ * Same rules and path length as bfsPathKeys (keys 'a'-'f', doors 'A'-'F').
+ * The SolverStats overload also records the search (see solver_stats.h).
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> astarPathKeys(const std::vector<std::string>& dungeon);
+std::vector<Cell> astarPathKeys(const Grid& dungeon);
+std::vector<Cell> astarPathKeys(const Grid& dungeon, SolverStats& stats);
@@ -0,0 +1,180 @@
+/**
+ * Dungeon Pathfinder - Batch Solver
+ *
+ * BFS with a persistent, generation-stamped workspace.
+ */
+
+#include "batch_solver.h"
+#include "solver.h"
+#include "keygraph.h"
+#include "thread_pool.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+// Parent record flag: entering this state picked up the key on its cell
+static const uint8_t PICKED_KEY = 4;
+
+void Solver::beginSearch(uint64_t states) {
+    if (marks_.size() < states) marks_.resize(states, 0);
+    if (++generation_ > MAX_GENERATION) {
+        // Generation counter wrapped: the only time the buffer is cleared
+        fill(marks_.begin(), marks_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+bool Solver::solveBasic(const Grid& dungeon, vector<Cell>& path) {
+    // Same indexing pass and tile classes as solveKeys; without keys every
+    // door stays shut
+    indexLevel(dungeon, level_);
+    int startIdx = level_.start;
+    int goalIdx = level_.goal;
+    if (startIdx == -1 || goalIdx == -1) return false;
+    tiles_.assign(dungeon, level_, DEFAULT_NUM_KEYS);
+
+    beginSearch(static_cast<uint64_t>(dungeon.size()));
+    queue_.clear();
+    queue_.push_back(startIdx);
+    claim(startIdx, 0);
+
+    // Track where each BFS level ends so the path length is known up front
+    size_t levelEnd = 1;
+    int depth = 0;
+    for (size_t head = 0; head < queue_.size(); head++) {
+        if (head == levelEnd) {
+            depth++;
+            levelEnd = queue_.size();
+        }
+        int cur = queue_[head];
+        if (cur == goalIdx) {
+            // Fill back to front: no reverse needed
+            path.resize(depth + 1);
+            for (int i = depth; i > 0; i--) {
+                path[i] = dungeon.cellAt(cur);
+                cur -= dungeon.offset(record(cur));
+            }
+            path[0] = dungeon.cellAt(startIdx);
+            return true;
+        }
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int next = cur + dungeon.offset(d);
+            uint8_t tile = tiles_[next];
+            if (tile == TILE_WALL || (tile & TILE_DOOR)) continue;
+            if (claim(next, static_cast<uint8_t>(d))) queue_.push_back(next);
+        }
+    }
+    return false;
+}
+
+bool Solver::solveKeys(const Grid& dungeon, vector<Cell>& path) {
+    // One indexing pass finds S and E and feeds the tile classes
+    indexLevel(dungeon, level_);
+    int startIdx = level_.start;
+    int goalIdx = level_.goal;
+    if (startIdx == -1 || goalIdx == -1) return false;
+
+    tiles_.assign(dungeon, level_, DEFAULT_NUM_KEYS);
+    if (keyGraphIsCheaper(tiles_)) return keyGraph_.solve(dungeon, level_, tiles_, path);
+
+    // Same layered state space as bfsPathKeys: state = keys * cells + cell
+    const uint64_t cells = static_cast<uint64_t>(dungeon.size());
+    beginSearch(cells * tiles_.numLayers());
+    frontierCells_.assign(1, startIdx);
+    frontierKeys_.assign(1, 0);
+    claim(startIdx, 0);
+
+    for (int depth = 1; !frontierCells_.empty(); depth++) {
+        nextCells_.clear();
+        nextKeys_.clear();
+        for (size_t i = 0; i < frontierCells_.size(); i++) {
+            int cur = frontierCells_[i];
+            for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                int nextIdx = cur + dungeon.offset(d);
+                uint8_t tile = tiles_[nextIdx];
+                if (tile == TILE_WALL) continue;
+
+                uint32_t keys = frontierKeys_[i];
+                uint8_t rec = static_cast<uint8_t>(d);
+                if (tile & TILE_DOOR) {
+                    if (!((keys >> (tile & TILE_BIT_MASK)) & 1)) continue;  // door locked
+                } else if (tile & TILE_KEY) {
+                    uint32_t bit = 1u << (tile & TILE_BIT_MASK);
+                    if (!(keys & bit)) rec |= PICKED_KEY;
+                    keys |= bit;
+                }
+
+                uint64_t next = keys * cells + nextIdx;
+                if (!claim(next, rec)) continue;
+
+                if (nextIdx == goalIdx) {
+                    path.resize(depth + 1);
+                    uint64_t s = next;
+                    for (int step = depth; step > 0; step--) {
+                        int sIdx = static_cast<int>(s % cells);
+                        uint64_t sKeys = s / cells;
+                        uint8_t r = record(s);
+                        path[step] = dungeon.cellAt(sIdx);
+                        if (r & PICKED_KEY) sKeys ^= uint64_t(1) << (tiles_[sIdx] & TILE_BIT_MASK);
+                        s = sKeys * cells + (sIdx - dungeon.offset(r & 3));
+                    }
+                    path[0] = dungeon.cellAt(startIdx);
+                    return true;
+                }
+                nextCells_.push_back(nextIdx);
+                nextKeys_.push_back(keys);
+            }
+        }
+        frontierCells_.swap(nextCells_);
+        frontierKeys_.swap(nextKeys_);
+    }
+    return false;
+}
+
+vector<Cell> Solver::solve(const Grid& dungeon, SolveRules rules) {
+    vector<Cell> path;
+    solveBatch(&dungeon, 1, &path, rules);
+    return path;
+}
+
+vector<Cell> Solver::solve(const vector<string>& dungeon, SolveRules rules) {
+    vector<Cell> path;
+    solveBatch(&dungeon, 1, &path, rules);
+    return path;
+}
+
+void Solver::solveBatch(const Grid* dungeons, size_t count, vector<Cell>* results,
+                        SolveRules rules) {
+    for (size_t i = 0; i < count; i++) {
+        bool found = rules == SolveRules::Keys ? solveKeys(dungeons[i], results[i])
+                                               : solveBasic(dungeons[i], results[i]);
+        if (!found) results[i].clear();
+    }
+}
+
+void Solver::solveBatch(const vector<string>* dungeons, size_t count, vector<Cell>* results,
+                        SolveRules rules) {
+    for (size_t i = 0; i < count; i++) {
+        grid_.assign(dungeons[i]);
+        solveBatch(&grid_, 1, &results[i], rules);
+    }
+}
+
+size_t Solver::bytes() const {
+    return marks_.capacity() * sizeof(uint32_t) + queue_.capacity() * sizeof(int) +
+           (frontierCells_.capacity() + nextCells_.capacity()) * sizeof(int) +
+           (frontierKeys_.capacity() + nextKeys_.capacity()) * sizeof(uint32_t) +
+           static_cast<size_t>(grid_.size()) + keyGraph_.bytes();
+}
+
+void solveBatchParallel(const vector<string>* dungeons, size_t count, vector<Cell>* results,
+                        SolveRules rules, int threads) {
+    if (threads <= 0) threads = solverThreads();
+    ThreadPool pool(threads);
+    vector<Solver> solvers(pool.size());
+    pool.parallelFor(count, 1, [&](size_t begin, size_t end, int worker) {
+        solvers[worker].solveBatch(dungeons + begin, end - begin, results + begin, rules);
+    });
+}
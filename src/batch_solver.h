@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "tiles.h"
+#include "level_index.h"
+#include "solver.h"
+#include "keygraph.h"
+
+/**
+ * Reusable BFS workspace for solving many dungeons in a row.
+ *
+ * bfsPath and bfsPathKeys allocate their visited, parent and queue buffers
+ * on every call. A Solver keeps them between calls: they only grow when a
+ * larger dungeon (or state space) arrives, and are never cleared. Instead,
+ * every search bumps a generation number, and a state counts as visited
+ * only if its mark carries the current generation, so starting a search is
+ * O(1) whatever the size of the previous one. The mark also holds the
+ * parent record, so a visited check and a parent write touch one word.
+ * Maps that bfsPathKeys would hand to the key graph go to a KeyGraphSolver
+ * kept in the Solver too, so no search allocates once the buffers fit.
+ *
+ * Paths are identical in length to bfsPath / bfsPathKeys. A Solver is not
+ * thread-safe; use one instance per thread (solveBatchParallel does this).
+ */
+class Solver {
+public:
+    Solver() = default;
+
+    /**
+     * Shortest path from S to E (same rules as bfsPath, or bfsPathKeys with
+     * SolveRules::Keys).
+     *
+     * @param dungeon The dungeon to solve
+     * @param rules Movement rules
+     * @return Path from S to E, or empty vector if no path exists
+     */
+    std::vector<Cell> solve(const Grid& dungeon, SolveRules rules = SolveRules::Basic);
+    std::vector<Cell> solve(const std::vector<std::string>& dungeon, SolveRules rules = SolveRules::Basic);
+
+    /**
+     * Solves dungeons[0 .. count) into results[0 .. count). Each result
+     * vector is overwritten in place, so its capacity is reused too.
+     *
+     * @param dungeons First of count dungeons
+     * @param count Number of dungeons
+     * @param results First of count output paths (empty when unsolvable)
+     * @param rules Movement rules
+     */
+    void solveBatch(const Grid* dungeons, size_t count, std::vector<Cell>* results,
+                    SolveRules rules = SolveRules::Basic);
+    void solveBatch(const std::vector<std::string>* dungeons, size_t count,
+                    std::vector<Cell>* results, SolveRules rules = SolveRules::Basic);
+
+    // Bytes currently held by the workspace buffers
+    size_t bytes() const;
+
+private:
+    bool solveBasic(const Grid& dungeon, std::vector<Cell>& path);
+    bool solveKeys(const Grid& dungeon, std::vector<Cell>& path);
+
+    // Starts a new search over states [0, states)
+    void beginSearch(uint64_t states);
+
+    bool visited(uint64_t state) const { return (marks_[state] >> RECORD_BITS) == generation_; }
+    uint8_t record(uint64_t state) const { return marks_[state] & RECORD_MASK; }
+
+    // Marks state as visited with its parent record; false if it already was
+    bool claim(uint64_t state, uint8_t record) {
+        if (visited(state)) return false;
+        marks_[state] = (generation_ << RECORD_BITS) | record;
+        return true;
+    }
+
+    static const int RECORD_BITS = 3;  // 2-bit direction + key-pickup flag
+    static const uint32_t RECORD_MASK = (1u << RECORD_BITS) - 1;
+    static const uint32_t MAX_GENERATION = (1u << (32 - RECORD_BITS)) - 1;
+
+    std::vector<uint32_t> marks_;  // generation << RECORD_BITS | parent record
+    uint32_t generation_ = 0;
+    std::vector<int> queue_;
+    std::vector<int> frontierCells_, nextCells_;
+    std::vector<uint32_t> frontierKeys_, nextKeys_;
+    Grid grid_;      // conversion buffer for vector<string> input
+    TileMap tiles_;
+    LevelIndex level_;
+    KeyGraphSolver keyGraph_;
+};
+
+/**
+ * Solves a batch on a thread pool with one Solver per worker thread.
+ *
+ * @param dungeons First of count dungeons
+ * @param count Number of dungeons
+ * @param results First of count output paths
+ * @param rules Movement rules
+ * @param threads Worker threads (0 = solverThreads())
+ */
+void solveBatchParallel(const std::vector<std::string>* dungeons, size_t count,
+                        std::vector<Cell>* results, SolveRules rules = SolveRules::Basic,
+                        int threads = 0);
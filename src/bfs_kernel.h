@@ -0,0 +1,248 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+#include "cell.h"
+#include "dense.h"
+#include "tiles.h"
+
+/**
+ * Tile rules for BfsKernel: which tiles a step may enter and how entering
+ * one changes the keys held. Rules without keys (KEYED false) keep a
+ * single key layer, and the kernel compiles out every key branch for them.
+ *
+ *   enter(idx, keys)  may a step end on idx; picks up the key there
+ *   open(idx, keys)   may a step pass idx, without picking anything up
+ *   keyAt(idx)        key bit a step onto idx picks up (keyed rules)
+ */
+
+// Only walls block; doors and keys are plain floor. Tiles is a layout
+// (see grid_layout.h) or Grid whose operator[] gives the tile character.
+template <typename Tiles>
+class PlainRule {
+public:
+    using Mask = uint8_t;
+    static constexpr bool KEYED = false;
+
+    explicit PlainRule(const Tiles& tiles) : tiles_(tiles) {}
+
+    int layers() const { return 1; }
+    bool enter(int idx, Mask&) const { return tiles_[idx] != '#'; }
+    bool open(int idx, Mask) const { return tiles_[idx] != '#'; }
+    Mask keyAt(int) const { return 0; }
+
+private:
+    const Tiles& tiles_;
+};
+
+// Walls and doors 'A'-'F' block ('E' is the exit), as in bfsPath
+template <typename Tiles>
+class DoorBlockRule {
+public:
+    using Mask = uint8_t;
+    static constexpr bool KEYED = false;
+
+    explicit DoorBlockRule(const Tiles& tiles) : tiles_(tiles) {}
+
+    int layers() const { return 1; }
+    bool enter(int idx, Mask&) const { return passable(tiles_[idx]); }
+    bool open(int idx, Mask) const { return passable(tiles_[idx]); }
+    Mask keyAt(int) const { return 0; }
+
+private:
+    static bool passable(char ch) { return !blocksWithoutKeys(ch); }
+
+    const Tiles& tiles_;
+};
+
+// Keys open the doors of their letter, as in bfsPathKeys; tiles come from
+// a TileMap, so the layout must be RowMajorLayout (Grid indices)
+template <int NumKeys>
+class KeyDoorRule {
+public:
+    using Mask = typename KeyAlphabet<NumKeys>::Mask;
+    static constexpr bool KEYED = true;
+
+    explicit KeyDoorRule(const TileMap& tiles) : tiles_(tiles) {}
+
+    int layers() const { return tiles_.numLayers(); }
+
+    bool enter(int idx, Mask& keys) const {
+        uint8_t tile = tiles_[idx];
+        if (tile == TILE_WALL) return false;
+        if (tile & TILE_DOOR) return (keys >> (tile & TILE_BIT_MASK)) & 1;  // locked without its key
+        if (tile & TILE_KEY) keys |= bit(tile);
+        return true;
+    }
+
+    bool open(int idx, Mask keys) const {
+        uint8_t tile = tiles_[idx];
+        return tile != TILE_WALL && (!(tile & TILE_DOOR) || ((keys >> (tile & TILE_BIT_MASK)) & 1));
+    }
+
+    Mask keyAt(int idx) const { return (tiles_[idx] & TILE_KEY) ? bit(tiles_[idx]) : 0; }
+
+private:
+    static Mask bit(uint8_t tile) { return static_cast<Mask>(Mask(1) << (tile & TILE_BIT_MASK)); }
+
+    const TileMap& tiles_;
+};
+
+/**
+ * The breadth-first search behind bfsPath, bfsPathKeys, bfsDistanceKeys,
+ * countReachableKeys and the HPA* cluster searches, specialized at compile
+ * time on
+ *   Moves    neighborhood: FourConnected or EightConnected (cell.h)
+ *   Rule     tile rule: PlainRule, DoorBlockRule or KeyDoorRule
+ *   Layout   tile indexing: RowMajorLayout or TiledGrid (grid_layout.h)
+ *   Parents  whether to keep parent records for path()
+ * The direction loop is unrolled with every step a compile-time constant,
+ * so each instantiation is the loop one would write by hand for it.
+ *
+ * States are (keys, cell) with state id keys * cells + cell: one visited
+ * bit and, with Parents, one record (direction taken in, plus a flag when
+ * that step picked up a key) per state. The search is level-synchronous,
+ * keeping only the current and next frontier. A diagonal step needs both
+ * orthogonal tiles it passes to be open (no cutting wall corners).
+ */
+template <typename Moves, typename Rule, typename Layout, bool Parents = true>
+class BfsKernel {
+public:
+    using Mask = typename Rule::Mask;
+
+    BfsKernel(const Layout& layout, const Rule& rule,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : layout_(layout), rule_(rule), cells_(static_cast<uint64_t>(layout.size())),
+          visited_(cells_ * rule.layers(), resource), parent_(Parents ? cells_ * rule.layers() : 0, resource),
+          frontier_(resource), next_(resource) {}
+
+    /**
+     * Searches from startIdx holding no keys. onReach(cell, keys) is called
+     * once for every state reached, the start included, and stops the
+     * search by returning true.
+     *
+     * @param startIdx Layout index of the start
+     * @param stats Stats policy (NoStats or StatsRecorder, see solver_stats.h)
+     * @param onReach Callback for each new state
+     * @return Moves to the state that stopped the search, or -1 if none did
+     */
+    template <typename Stats, typename OnReach>
+    int run(int startIdx, Stats& stats, OnReach&& onReach) {
+        start_ = startIdx;
+        depth_ = 0;
+        stats.layers(rule_.layers());
+        visited_.set(startIdx);
+        stats.push();
+        stats.visit(0);
+        if (onReach(startIdx, Mask(0))) {
+            found_ = static_cast<uint64_t>(startIdx);
+            return 0;
+        }
+
+        frontier_.assign(1, Node{startIdx, Mask(0)});
+        for (int depth = 1; !frontier_.empty(); depth++) {
+            depth_ = depth;
+            for (const Node& cur : frontier_) {
+                stats.pop();
+                if (!expand(cur, stats, onReach, std::make_integer_sequence<int, Moves::SIZE>())) return depth;
+            }
+            frontier_.swap(next_);
+            next_.clear();
+            stats.frontier(frontier_.size());
+        }
+        return -1;
+    }
+
+    // Moves from the start to the state onReach is being called for
+    int depth() const { return depth_; }
+
+    /**
+     * Path from the start to the state that stopped run(), filled back to
+     * front from the parent records.
+     *
+     * @param depth What run() returned (not -1)
+     * @param out Receives depth + 1 cells
+     */
+    template <typename Path>
+    void path(int depth, Path& out) const {
+        static_assert(Parents, "path() needs parent records");
+        out.resize(depth + 1);
+        uint64_t s = found_;
+        for (int i = depth; i > 0; i--) {
+            int cell = Rule::KEYED ? static_cast<int>(s % cells_) : static_cast<int>(s);
+            uint64_t keys = Rule::KEYED ? s / cells_ : 0;
+            uint8_t record = parent_.get(s);
+            out[i] = layout_.cellAt(cell);
+            if (record & PICKED_KEY) keys ^= rule_.keyAt(cell);
+            const int* back = Moves::STEPS[(record & (Moves::SIZE - 1)) ^ 1];
+            s = keys * cells_ + layout_.step(cell, back[0], back[1]);
+        }
+        out[0] = layout_.cellAt(start_);
+    }
+
+private:
+    static constexpr uint8_t PICKED_KEY = Rule::KEYED ? Moves::SIZE : 0;
+    static constexpr int RECORD_BITS = (Rule::KEYED || Moves::SIZE > 4) ? 4 : 2;
+
+    struct Node {
+        int cell;
+        Mask keys;
+    };
+
+    uint64_t stateId(int cell, Mask keys) const {
+        if constexpr (Rule::KEYED) {
+            return keys * cells_ + cell;
+        } else {
+            return static_cast<uint64_t>(cell);
+        }
+    }
+
+    // Tries every direction from cur; false once onReach stopped the search
+    template <typename Stats, typename OnReach, int... D>
+    bool expand(const Node& cur, Stats& stats, OnReach& onReach, std::integer_sequence<int, D...>) {
+        return (tryMove<D>(cur, stats, onReach) && ...);
+    }
+
+    template <int D, typename Stats, typename OnReach>
+    bool tryMove(const Node& cur, Stats& stats, OnReach& onReach) {
+        constexpr int dr = Moves::STEPS[D][0], dc = Moves::STEPS[D][1];
+        if constexpr (dr != 0 && dc != 0) {
+            if (!rule_.open(layout_.step(cur.cell, dr, 0), cur.keys) ||
+                !rule_.open(layout_.step(cur.cell, 0, dc), cur.keys)) return true;
+        }
+        // The wall border makes every neighbor index valid
+        int next = layout_.step(cur.cell, dr, dc);
+        Mask keys = cur.keys;
+        if (!rule_.enter(next, keys)) return true;
+
+        uint64_t id = stateId(next, keys);
+        if (visited_.testAndSet(id)) return true;
+        if constexpr (Parents) {
+            uint8_t record = static_cast<uint8_t>(D);
+            if constexpr (Rule::KEYED) {
+                if (keys != cur.keys) record |= PICKED_KEY;
+            }
+            parent_.set(id, record);
+        }
+        stats.visit(Rule::KEYED ? keys : 0);
+        if (onReach(next, keys)) {
+            found_ = id;
+            return false;
+        }
+        next_.push_back(Node{next, keys});
+        stats.push();
+        return true;
+    }
+
+    const Layout& layout_;
+    const Rule& rule_;
+    uint64_t cells_;
+    BitSet visited_;
+    PackedArray<RECORD_BITS> parent_;
+    std::pmr::vector<Node> frontier_, next_;
+    int start_ = -1;
+    int depth_ = 0;
+    uint64_t found_ = 0;
+};
@@ -0,0 +1,288 @@
+/**
+ * Dungeon Pathfinder - Bit-Parallel BFS
+ *
+ * Frontier flood fill over row bitsets, 64 cells per word.
+ */
+
+#include "bitbfs.h"
+#include "solver_stats.h"
+#include "tiles.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// Passable cells as row bitsets: bit (c % 64) of word r * wordsPerRow + c / 64
+class BitBoard {
+public:
+    explicit BitBoard(const Grid& dungeon)
+        : rows(dungeon.rows()), cols(dungeon.cols()), wordsPerRow((dungeon.cols() + 63) / 64),
+          passable_(static_cast<size_t>(rows) * wordsPerRow, 0) {
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                char ch = dungeon.at(r, c);
+                if (!blocksWithoutKeys(ch)) passable_[word(r, c)] |= bit(c);
+            }
+        }
+    }
+
+    size_t word(int r, int c) const { return static_cast<size_t>(r) * wordsPerRow + c / 64; }
+    static uint64_t bit(int c) { return uint64_t(1) << (c % 64); }
+    uint64_t passable(size_t w) const { return passable_[w]; }
+    size_t size() const { return passable_.size(); }
+
+    int rows, cols, wordsPerRow;
+
+private:
+    vector<uint64_t> passable_;
+};
+
+// Same interface over an external wall plane (1 = blocked), read in place.
+// Padding bits past the last column are masked off, whatever they hold.
+class WallBoard {
+public:
+    explicit WallBoard(const WallPlane& plane)
+        : rows(plane.rows), cols(plane.cols), wordsPerRow(plane.wordsPerRow), walls_(plane.words),
+          tail_(cols % 64 ? (uint64_t(1) << (cols % 64)) - 1 : ~uint64_t(0)) {}
+
+    size_t word(int r, int c) const { return static_cast<size_t>(r) * wordsPerRow + c / 64; }
+    static uint64_t bit(int c) { return uint64_t(1) << (c % 64); }
+    uint64_t passable(size_t w) const {
+        uint64_t open = ~walls_[w];
+        return (w % wordsPerRow == static_cast<size_t>((cols - 1) / 64)) ? open & tail_ : open;
+    }
+    size_t size() const { return static_cast<size_t>(rows) * wordsPerRow; }
+
+    int rows, cols, wordsPerRow;
+
+private:
+    const uint64_t* walls_;
+    uint64_t tail_;
+};
+
+// All BFS layers, each a sorted list of (word index, bits) pairs
+struct Layers {
+    vector<uint32_t> words;
+    vector<uint64_t> bits;
+    vector<size_t> start{0};  // layer l spans [start[l], start[l + 1])
+
+    size_t count() const { return start.size() - 1; }
+
+    // Bits of word w in layer l (0 if the layer has no cells there)
+    uint64_t lookup(size_t l, uint32_t w) const {
+        auto first = words.begin() + start[l];
+        auto last = words.begin() + start[l + 1];
+        auto it = lower_bound(first, last, w);
+        return (it != last && *it == w) ? bits[it - words.begin()] : 0;
+    }
+};
+
+// Number of set bits (cells) in a word
+inline uint64_t bitCount(uint64_t x) {
+#if defined(__GNUC__)
+    return static_cast<uint64_t>(__builtin_popcountll(x));
+#else
+    uint64_t count = 0;
+    for (; x; x &= x - 1) count++;
+    return count;
+#endif
+}
+
+// Spreads the cells x of word w one step in each direction, passing each
+// neighbor word and its bits to add
+template <typename Add>
+inline void spreadWord(size_t w, uint64_t x, int wordsPerRow, int rows, Add& add) {
+    int r = static_cast<int>(w / wordsPerRow);
+    int wc = static_cast<int>(w % wordsPerRow);
+
+    add(w, (x << 1) | (x >> 1));
+    if (wc > 0) add(w - 1, x << 63);                // column 0 of this word -> 63 of previous
+    if (wc < wordsPerRow - 1) add(w + 1, x >> 63);  // column 63 -> 0 of next word
+    if (r > 0) add(w - wordsPerRow, x);
+    if (r < rows - 1) add(w + wordsPerRow, x);
+}
+
+// Flood fill from start to goal over any board exposing passable words,
+// reporting to a stats policy (see solver_stats.h)
+template <typename Board, typename Stats>
+vector<Cell> bitParallelSearch(const Board& board, Cell start, Cell goal, Stats& stats) {
+    const int W = board.wordsPerRow;
+    const size_t goalWord = board.word(goal.r, goal.c);
+    const uint64_t goalBit = Board::bit(goal.c);
+
+    vector<uint64_t> visited(board.size(), 0);
+    vector<uint64_t> spread(board.size(), 0);  // neighbors of the frontier
+    vector<uint32_t> dirty;
+
+    Layers layers;
+    uint32_t startWord = static_cast<uint32_t>(board.word(start.r, start.c));
+    layers.words.push_back(startWord);
+    layers.bits.push_back(Board::bit(start.c));
+    layers.start.push_back(1);
+    visited[startWord] = Board::bit(start.c);
+    stats.layers(1);
+    stats.push();
+    stats.visit(0);
+    uint64_t frontierCells = 1;
+    auto account = [&] {
+        stats.allocated(capacityBytes(visited) + capacityBytes(spread) + capacityBytes(dirty) +
+                        capacityBytes(layers.words) + capacityBytes(layers.bits) + capacityBytes(layers.start));
+    };
+
+    auto addSpread = [&](size_t w, uint64_t bits) {
+        if (!bits) return;
+        if (!spread[w]) dirty.push_back(static_cast<uint32_t>(w));
+        spread[w] |= bits;
+    };
+
+    bool found = false;
+    while (!found) {
+        size_t l = layers.count() - 1;
+        dirty.clear();
+        stats.pop(frontierCells);
+        frontierCells = 0;
+
+        // Spread every frontier word one step in each direction
+        for (size_t i = layers.start[l]; i < layers.start[l + 1]; i++) {
+            spreadWord(layers.words[i], layers.bits[i], W, board.rows, addSpread);
+        }
+
+        // Mask to unvisited passable cells; this is the next layer
+        sort(dirty.begin(), dirty.end());
+        for (uint32_t w : dirty) {
+            uint64_t next = spread[w] & board.passable(w) & ~visited[w];
+            spread[w] = 0;
+            if (!next) continue;
+            visited[w] |= next;
+            layers.words.push_back(w);
+            layers.bits.push_back(next);
+            if (w == goalWord && (next & goalBit)) found = true;
+            if constexpr (Stats::enabled) frontierCells += bitCount(next);
+        }
+        stats.push(frontierCells);
+        stats.visit(0, frontierCells);
+        stats.frontier(frontierCells);
+        if (layers.words.size() == layers.start.back()) {  // frontier died out
+            account();
+            return {};
+        }
+        layers.start.push_back(layers.words.size());
+    }
+    account();
+    stats.phase(SolvePhase::Reconstruct);
+
+    // Walk back from E: in each earlier layer, some neighbor of the current
+    // cell is present, and that neighbor is one step closer to S
+    size_t length = layers.count();
+    vector<Cell> path(length);
+    Cell cur = goal;
+    path[length - 1] = cur;
+    for (size_t l = length - 1; l-- > 0; ) {
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int nr = cur.r + DIRECTIONS[d][0];
+            int nc = cur.c + DIRECTIONS[d][1];
+            if (nr < 0 || nr >= board.rows || nc < 0 || nc >= board.cols) continue;
+            if (layers.lookup(l, static_cast<uint32_t>(board.word(nr, nc))) & Board::bit(nc)) {
+                cur = Cell(nr, nc);
+                break;
+            }
+        }
+        path[l] = cur;
+    }
+    return path;
+}
+
+// Same flood fill, keeping only the current frontier: returns the number of
+// layers to the goal (its BFS distance), or -1
+template <typename Board>
+int bitParallelDistance(const Board& board, Cell start, Cell goal) {
+    if (start == goal) return 0;
+    const int W = board.wordsPerRow;
+    const size_t goalWord = board.word(goal.r, goal.c);
+    const uint64_t goalBit = Board::bit(goal.c);
+
+    vector<uint64_t> visited(board.size(), 0);
+    vector<uint64_t> spread(board.size(), 0);
+    vector<uint32_t> dirty;
+    vector<uint32_t> frontierWords{static_cast<uint32_t>(board.word(start.r, start.c))};
+    vector<uint64_t> frontierBits{Board::bit(start.c)};
+    visited[frontierWords[0]] = frontierBits[0];
+
+    auto addSpread = [&](size_t w, uint64_t bits) {
+        if (!bits) return;
+        if (!spread[w]) dirty.push_back(static_cast<uint32_t>(w));
+        spread[w] |= bits;
+    };
+
+    for (int depth = 1; !frontierWords.empty(); depth++) {
+        dirty.clear();
+        for (size_t i = 0; i < frontierWords.size(); i++) {
+            spreadWord(frontierWords[i], frontierBits[i], W, board.rows, addSpread);
+        }
+
+        // Layer order does not matter here, so dirty words are not sorted
+        frontierWords.clear();
+        frontierBits.clear();
+        for (uint32_t w : dirty) {
+            uint64_t next = spread[w] & board.passable(w) & ~visited[w];
+            spread[w] = 0;
+            if (!next) continue;
+            if (w == goalWord && (next & goalBit)) return depth;
+            visited[w] |= next;
+            frontierWords.push_back(w);
+            frontierBits.push_back(next);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+template <typename Stats>
+static vector<Cell> searchGrid(const Grid& dungeon, Stats& stats) {
+    int startIdx = dungeon.find('S');
+    int goalIdx = dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+    return bitParallelSearch(BitBoard(dungeon), dungeon.cellAt(startIdx), dungeon.cellAt(goalIdx), stats);
+}
+
+vector<Cell> bfsPathBitParallel(const Grid& dungeon) {
+    NoStats stats;
+    return searchGrid(dungeon, stats);
+}
+
+vector<Cell> bfsPathBitParallel(const Grid& dungeon, SolverStats& stats) {
+    StatsRecorder recorder(stats);
+    return searchGrid(dungeon, recorder);
+}
+
+vector<Cell> bfsPathBitParallel(const WallPlane& walls, Cell start, Cell goal) {
+    if (walls.rows <= 0 || walls.cols <= 0) return {};
+    if (start.r < 0 || start.r >= walls.rows || start.c < 0 || start.c >= walls.cols) return {};
+    if (goal.r < 0 || goal.r >= walls.rows || goal.c < 0 || goal.c >= walls.cols) return {};
+    NoStats stats;
+    return bitParallelSearch(WallBoard(walls), start, goal, stats);
+}
+
+vector<Cell> bfsPathBitParallel(const vector<string>& dungeon) {
+    return bfsPathBitParallel(Grid::fromStrings(dungeon));
+}
+
+int bfsDistanceBitParallel(const Grid& dungeon) {
+    int startIdx = dungeon.find('S');
+    int goalIdx = dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return -1;
+    return bitParallelDistance(BitBoard(dungeon), dungeon.cellAt(startIdx), dungeon.cellAt(goalIdx));
+}
+
+int bfsDistanceBitParallel(const WallPlane& walls, Cell start, Cell goal) {
+    if (walls.rows <= 0 || walls.cols <= 0) return -1;
+    if (start.r < 0 || start.r >= walls.rows || start.c < 0 || start.c >= walls.cols) return -1;
+    if (goal.r < 0 || goal.r >= walls.rows || goal.c < 0 || goal.c >= walls.cols) return -1;
+    return bitParallelDistance(WallBoard(walls), start, goal);
+}
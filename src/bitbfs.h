@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "cell.h"
+#include "grid.h"
+#include "solver_stats.h"
+
+/**
+ * Bit-parallel BFS (bitboard flood fill).
+ *
+ * Passable cells, visited cells and each BFS layer are stored as row
+ * bitsets, 64 cells per word. A layer is computed word by word as
+ *     (left | right | up | down of the frontier) & passable & ~visited
+ * so one word operation expands up to 64 cells. Only words that hold
+ * frontier cells are touched, so long thin corridors do not pay for a
+ * full-grid sweep per layer.
+ *
+ * Every layer is kept as a sparse list of non-empty words; the path is
+ * rebuilt backwards from E by finding, in each earlier layer, a neighbor of
+ * the current cell. Doors block movement, as in bfsPath.
+ * The SolverStats overload also records the search (see solver_stats.h);
+ * its counters are in cells, added a whole layer at a time.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathBitParallel(const std::vector<std::string>& dungeon);
+std::vector<Cell> bfsPathBitParallel(const Grid& dungeon);
+std::vector<Cell> bfsPathBitParallel(const Grid& dungeon, SolverStats& stats);
+
+/**
+ * Row-bitset view of a dungeon's blocked cells (walls and doors), in the
+ * layout the bit-parallel BFS works on: bit (c % 64) of
+ * words[r * wordsPerRow + c / 64] is set when (r, c) is blocked. Bits past
+ * the last column are ignored. The words are not copied or owned, so a
+ * plane read straight from a packed level file can be searched in place.
+ */
+struct WallPlane {
+    const uint64_t* words = nullptr;
+    int rows = 0, cols = 0, wordsPerRow = 0;
+};
+
+/**
+ * Bit-parallel BFS over an external wall plane.
+ *
+ * @param walls Blocked cells as row bitsets
+ * @param start Start position
+ * @param goal Exit position
+ * @return Path from start to goal, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathBitParallel(const WallPlane& walls, Cell start, Cell goal);
+
+/**
+ * Distance-only bit-parallel BFS: the same flood fill, keeping just the
+ * current frontier instead of every layer, and stopping as soon as E is
+ * reached. Doors block movement, as in bfsPath.
+ *
+ * @param dungeon The dungeon grid
+ * @return Number of moves from S to E, or -1 if E is unreachable
+ */
+int bfsDistanceBitParallel(const Grid& dungeon);
+int bfsDistanceBitParallel(const WallPlane& walls, Cell start, Cell goal);
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 
 /**
  * Simple coordinate structure for representing positions in the dungeon.
@@ -27,12 +30,32 @@ struct Cell {
  */
 struct CellHash {
     size_t operator()(const Cell& cell) const {
-        // Simple hash combining row and column
-        return static_cast<size_t>(cell.r) * 1000 + static_cast<size_t>(cell.c);
+        // Pack both 32-bit coordinates into one 64-bit key so distinct cells
+        // never collide, whatever the grid width
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(cell.r)) << 32) |
+                       static_cast<uint32_t>(cell.c);
+        return std::hash<uint64_t>()(key);
     }
 };
 
 // Direction vectors for moving in 4 cardinal directions (up, down, left, right)
 // Useful for both maze generation and pathfinding
-const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-const int NUM_DIRECTIONS = 4;
\ No newline at end of file
+constexpr int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+constexpr int NUM_DIRECTIONS = 4;
+
+/**
+ * Compile-time neighborhoods for the templated BFS kernel (bfs_kernel.h).
+ * STEPS[d] is the (row, col) delta of direction d. The first four are
+ * DIRECTIONS, and opposite directions differ only in the lowest bit, so
+ * d ^ 1 undoes a step.
+ */
+struct FourConnected {
+    static constexpr int SIZE = 4;
+    static constexpr int STEPS[SIZE][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+};
+
+struct EightConnected {
+    static constexpr int SIZE = 8;
+    static constexpr int STEPS[SIZE][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1},
+                                           {-1, -1}, {1, 1}, {-1, 1}, {1, -1}};
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Fixed-size bitset indexed by a linear cell (or state) id.
+ * Used by the solvers for visited tracking: one bit per cell instead of a
+ * hash-set node per visited cell. Storage comes from the given memory
+ * resource, so a caller's arena can back it.
+ */
+class BitSet {
+public:
+    BitSet() = default;
+    explicit BitSet(size_t size,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : words_((size + 63) / 64, 0, resource) {}
+
+    bool test(size_t i) const { return (words_[i >> 6] >> (i & 63)) & 1; }
+    void set(size_t i) { words_[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(size_t i) { words_[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+
+    // Sets bit i and returns whether it was already set
+    bool testAndSet(size_t i) {
+        uint64_t bit = uint64_t(1) << (i & 63);
+        uint64_t& word = words_[i >> 6];
+        bool was = word & bit;
+        word |= bit;
+        return was;
+    }
+
+    void clear() { std::fill(words_.begin(), words_.end(), 0); }
+    size_t bytes() const { return words_.size() * sizeof(uint64_t); }
+
+private:
+    std::pmr::vector<uint64_t> words_;
+};
+
+/**
+ * BitSet whose testAndSet is atomic, so several threads can claim cells of
+ * the same visited array concurrently (used by the parallel solvers).
+ */
+class AtomicBitSet {
+public:
+    explicit AtomicBitSet(size_t size)
+        : size_((size + 63) / 64), words_(new std::atomic<uint64_t>[size_]()) {}
+
+    bool test(size_t i) const {
+        return (words_[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+    }
+
+    // Atomically sets bit i; returns true if it was already set
+    bool testAndSet(size_t i) {
+        uint64_t bit = uint64_t(1) << (i & 63);
+        return words_[i >> 6].fetch_or(bit, std::memory_order_relaxed) & bit;
+    }
+
+    size_t bytes() const { return size_ * sizeof(uint64_t); }
+
+private:
+    size_t size_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+/**
+ * Array of small unsigned values packed Bits at a time into bytes.
+ * Bits must be 1, 2 or 4. The solvers store a parent direction (2 bits) or a
+ * direction plus a key-pickup flag (4 bits) per cell or state.
+ */
+template <int Bits>
+class PackedArray {
+    static_assert(Bits == 1 || Bits == 2 || Bits == 4, "Bits must divide 8");
+    static constexpr int PER_BYTE = 8 / Bits;
+    static constexpr uint8_t MASK = (1 << Bits) - 1;
+
+public:
+    PackedArray() = default;
+    explicit PackedArray(size_t size,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : bytes_((size + PER_BYTE - 1) / PER_BYTE, 0, resource) {}
+
+    uint8_t get(size_t i) const {
+        return (bytes_[i / PER_BYTE] >> ((i % PER_BYTE) * Bits)) & MASK;
+    }
+
+    void set(size_t i, uint8_t value) {
+        int shift = (i % PER_BYTE) * Bits;
+        uint8_t& byte = bytes_[i / PER_BYTE];
+        byte = static_cast<uint8_t>((byte & ~(MASK << shift)) | ((value & MASK) << shift));
+    }
+
+    // Holds at least size entries; existing ones keep their values, new ones are 0
+    void reserve(size_t size) {
+        size_t bytes = (size + PER_BYTE - 1) / PER_BYTE;
+        if (bytes_.size() < bytes) bytes_.resize(bytes, 0);
+    }
+
+    size_t bytes() const { return bytes_.size(); }
+
+private:
+    std::pmr::vector<uint8_t> bytes_;
+};
@@ -0,0 +1,203 @@
+/**
+ * Dungeon Pathfinder - Distance Fields
+ *
+ * One BFS from a source, answering distance and path queries to any cell.
+ */
+
+#include "distance_field.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+DistanceField::DistanceField(const Grid& dungeon, Cell source, SolveRules rules)
+    : rows_(dungeon.rows()), cols_(dungeon.cols()), stride_(dungeon.stride()),
+      source_(source), rules_(rules), tiles_(dungeon, DEFAULT_NUM_KEYS),
+      cells_(static_cast<uint64_t>(dungeon.size())) {
+    for (int d = 0; d < NUM_DIRECTIONS; d++) offsets_[d] = dungeon.offset(d);
+
+    // Basic rules: doors never open, and keys are plain floor
+    const bool keys = rules == SolveRules::Keys;
+    const uint64_t layers = keys ? tiles_.numLayers() : 1;
+    dist_.assign(cells_ * layers, UNREACHED);
+
+    int sourceIdx = indexOf(source);
+    if (sourceIdx == -1 || tiles_[sourceIdx] == TILE_WALL) return;
+    if (!keys && (tiles_[sourceIdx] & TILE_DOOR)) return;
+
+    uint64_t startKeys = 0;
+    if (keys && (tiles_[sourceIdx] & TILE_KEY)) startKeys = uint64_t(1) << (tiles_[sourceIdx] & TILE_BIT_MASK);
+
+    vector<uint64_t> q{startKeys * cells_ + sourceIdx};
+    dist_[q[0]] = 0;
+    for (size_t head = 0; head < q.size(); head++) {
+        uint64_t state = q[head];
+        uint64_t stateKeys = state / cells_;
+        int idx = static_cast<int>(state % cells_);
+        uint32_t next = dist_[state] + 1;
+
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int n = idx + offsets_[d];
+            uint8_t tile = tiles_[n];
+            if (tile == TILE_WALL) continue;
+
+            uint64_t newKeys = stateKeys;
+            if (tile & TILE_DOOR) {
+                if (!keys || !((newKeys >> (tile & TILE_BIT_MASK)) & 1)) continue;  // door locked
+            } else if (keys && (tile & TILE_KEY)) {
+                newKeys |= uint64_t(1) << (tile & TILE_BIT_MASK);
+            }
+
+            uint64_t s = newKeys * cells_ + n;
+            if (dist_[s] != UNREACHED) continue;
+            dist_[s] = next;
+            q.push_back(s);
+        }
+    }
+
+    // Collapse the key layers so distanceTo is a single lookup
+    if (layers > 1) {
+        best_.assign(cells_, UNREACHED);
+        bestLayer_.assign(cells_, 0);
+        for (uint64_t layer = 0; layer < layers; layer++) {
+            const uint32_t* row = dist_.data() + layer * cells_;
+            for (uint64_t idx = 0; idx < cells_; idx++) {
+                if (row[idx] < best_[idx]) {
+                    best_[idx] = row[idx];
+                    bestLayer_[idx] = static_cast<uint8_t>(layer);
+                }
+            }
+        }
+    }
+}
+
+int DistanceField::indexOf(Cell target) const {
+    if (target.r < 0 || target.r >= rows_ || target.c < 0 || target.c >= cols_) return -1;
+    return (target.r + 1) * stride_ + (target.c + 1);
+}
+
+int DistanceField::distanceTo(Cell target) const {
+    int idx = indexOf(target);
+    if (idx == -1) return -1;
+    uint32_t d = best_.empty() ? dist_[idx] : best_[idx];
+    return d == UNREACHED ? -1 : static_cast<int>(d);
+}
+
+vector<Cell> DistanceField::pathTo(Cell target) const {
+    int distance = distanceTo(target);
+    if (distance < 0) return {};
+
+    int idx = indexOf(target);
+    uint64_t keys = best_.empty() ? 0 : bestLayer_[idx];
+    vector<Cell> path(distance + 1);
+    path[distance] = target;
+
+    // Each step back finds a neighbor state one move closer to the source.
+    // Entering a key cell may have picked the key up, so the neighbor can
+    // also sit in the layer without that key.
+    for (int step = distance; step > 0; step--) {
+        uint32_t want = static_cast<uint32_t>(step - 1);
+        uint8_t tile = tiles_[idx];
+        uint64_t candidates[2] = {keys, keys};
+        if (rules_ == SolveRules::Keys && (tile & TILE_KEY)) {
+            candidates[1] = keys & ~(uint64_t(1) << (tile & TILE_BIT_MASK));
+        }
+
+        bool moved = false;
+        for (int d = 0; d < NUM_DIRECTIONS && !moved; d++) {
+            int prev = idx - offsets_[d];
+            for (uint64_t layer : candidates) {
+                if (dist_[layer * cells_ + prev] == want) {
+                    idx = prev;
+                    keys = layer;
+                    moved = true;
+                    break;
+                }
+            }
+        }
+        path[step - 1] = cellAt(idx);
+    }
+    return path;
+}
+
+size_t DistanceField::bytes() const {
+    return dist_.size() * sizeof(uint32_t) + best_.size() * sizeof(uint32_t) + bestLayer_.size();
+}
+
+uint64_t dungeonId(const Grid& dungeon) {
+    // FNV-1a over the dimensions and every row
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](const void* data, size_t length) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < length; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+    };
+    int dims[2] = {dungeon.rows(), dungeon.cols()};
+    mix(dims, sizeof(dims));
+    for (int r = 0; r < dungeon.rows(); r++) {
+        mix(dungeon.data() + dungeon.index(r, 0), dungeon.cols());
+    }
+    return hash;
+}
+
+size_t DistanceFieldCache::KeyHash::operator()(const Key& key) const {
+    uint64_t h = key.dungeon;
+    h ^= (static_cast<uint64_t>(static_cast<uint32_t>(key.row)) << 32 |
+          static_cast<uint32_t>(key.col)) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint64_t>(key.rules) + (h >> 29);
+    return hash<uint64_t>()(h);
+}
+
+DistanceFieldCache::DistanceFieldCache(size_t capacity) : capacity_(max<size_t>(capacity, 1)) {}
+
+shared_ptr<const DistanceField> DistanceFieldCache::get(uint64_t id, const Grid& dungeon,
+                                                        Cell source, SolveRules rules) {
+    Key key{id, source.r, source.c, rules};
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto it = fields_.find(key);
+        if (it != fields_.end()) {
+            hits_++;
+            return it->second;
+        }
+        misses_++;
+    }
+
+    // Build outside the lock so other lookups are not held up by the BFS;
+    // if two threads race on the same key, the first insert wins
+    auto field = make_shared<const DistanceField>(dungeon, source, rules);
+
+    lock_guard<mutex> lock(mutex_);
+    auto inserted = fields_.emplace(key, field);
+    if (!inserted.second) return inserted.first->second;
+    order_.push_back(key);
+    while (fields_.size() > capacity_) {
+        fields_.erase(order_.front());
+        order_.pop_front();
+    }
+    return field;
+}
+
+size_t DistanceFieldCache::size() const {
+    lock_guard<mutex> lock(mutex_);
+    return fields_.size();
+}
+
+size_t DistanceFieldCache::hits() const {
+    lock_guard<mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t DistanceFieldCache::misses() const {
+    lock_guard<mutex> lock(mutex_);
+    return misses_;
+}
+
+void DistanceFieldCache::clear() {
+    lock_guard<mutex> lock(mutex_);
+    fields_.clear();
+    order_.clear();
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "tiles.h"
+#include "solver.h"
+
+/**
+ * Shortest distances from one source to every reachable cell, computed by a
+ * single BFS. With SolveRules::Keys the BFS runs over every key layer (as in
+ * bfsPathKeys) and each cell keeps its best layer, so a query is still one
+ * lookup.
+ *
+ * No parent records are stored: pathTo() walks back from the target to any
+ * neighbor (in the same key layer, or the layer before a key pickup) whose
+ * distance is one less.
+ */
+class DistanceField {
+public:
+    /**
+     * Runs the BFS from source.
+     *
+     * @param dungeon The dungeon grid
+     * @param source Cell to measure from (a key there counts as collected)
+     * @param rules Movement rules
+     */
+    DistanceField(const Grid& dungeon, Cell source, SolveRules rules = SolveRules::Basic);
+
+    Cell source() const { return source_; }
+    SolveRules rules() const { return rules_; }
+
+    /**
+     * @param target Any dungeon position
+     * @return Number of moves from the source, or -1 if unreachable
+     */
+    int distanceTo(Cell target) const;
+
+    /**
+     * Shortest path from the source to target, in O(path length).
+     *
+     * @param target Any dungeon position
+     * @return Path from source to target, or empty vector if unreachable
+     */
+    std::vector<Cell> pathTo(Cell target) const;
+
+    // Bytes held by the distance tables
+    size_t bytes() const;
+
+private:
+    static constexpr uint32_t UNREACHED = 0xFFFFFFFFu;
+
+    // Linear index of target, or -1 when it is off the map
+    int indexOf(Cell target) const;
+    Cell cellAt(int idx) const { return Cell(idx / stride_ - 1, idx % stride_ - 1); }
+
+    int rows_, cols_, stride_;
+    int offsets_[NUM_DIRECTIONS];
+    Cell source_;
+    SolveRules rules_;
+    TileMap tiles_;
+    uint64_t cells_;
+    std::vector<uint32_t> dist_;       // per state: keys * cells + cell index
+    std::vector<uint32_t> best_;       // per cell: minimum over key layers (Keys only)
+    std::vector<uint8_t> bestLayer_;   // per cell: layer achieving best_ (Keys only)
+};
+
+/**
+ * Content hash of a dungeon, usable as the dungeon id of a
+ * DistanceFieldCache when the caller has no id (such as a seed) of its own.
+ */
+uint64_t dungeonId(const Grid& dungeon);
+
+/**
+ * Thread-safe cache of distance fields keyed by (dungeon id, source,
+ * rules). A repeated query against the same map returns the stored field
+ * without searching. When full, the oldest field is evicted; fields are
+ * shared, so one still in use stays valid.
+ */
+class DistanceFieldCache {
+public:
+    explicit DistanceFieldCache(size_t capacity = 64);
+
+    /**
+     * Returns the field for (dungeonId, source, rules), building it on a miss.
+     *
+     * @param id Caller's id for the dungeon (same id must mean same map)
+     * @param dungeon The dungeon, only read on a miss
+     * @param source Cell to measure from
+     * @param rules Movement rules
+     */
+    std::shared_ptr<const DistanceField> get(uint64_t id, const Grid& dungeon, Cell source,
+                                             SolveRules rules = SolveRules::Basic);
+
+    size_t size() const;
+    size_t hits() const;
+    size_t misses() const;
+    void clear();
+
+private:
+    struct Key {
+        uint64_t dungeon;
+        int row, col;
+        SolveRules rules;
+        bool operator==(const Key& other) const {
+            return dungeon == other.dungeon && row == other.row && col == other.col &&
+                   rules == other.rules;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, std::shared_ptr<const DistanceField>, KeyHash> fields_;
+    std::deque<Key> order_;  // insertion order, for eviction
+    size_t capacity_;
+    size_t hits_ = 0, misses_ = 0;
+};
@@ -0,0 +1,149 @@
+#include "dungeon_io.h"
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Raw descriptor I/O, retrying short writes
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned>(length));
+#else
+        ssize_t written = ::write(fd, data, length);
+#endif
+        if (written <= 0) return false;
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+static long readSome(int fd, char* data, size_t length) {
+#ifdef _WIN32
+    return _read(fd, data, static_cast<unsigned>(length));
+#else
+    return static_cast<long>(::read(fd, data, length));
+#endif
+}
+
+DungeonWriter::DungeonWriter(ostream& out, size_t chunkSize)
+    : stream_(&out), buffer_(max<size_t>(chunkSize, 1)) {}
+
+DungeonWriter::DungeonWriter(int fd, size_t chunkSize)
+    : fd_(fd), buffer_(max<size_t>(chunkSize, 1)) {}
+
+DungeonWriter::~DungeonWriter() {
+    flush();
+}
+
+void DungeonWriter::write(const char* data, size_t length) {
+    while (length > 0) {
+        if (used_ == 0 && length >= buffer_.size()) {
+            // Whole chunks bypass the buffer
+            size_t whole = length - length % buffer_.size();
+            emit(data, whole);
+            data += whole;
+            length -= whole;
+            continue;
+        }
+        size_t n = min(length, buffer_.size() - used_);
+        memcpy(buffer_.data() + used_, data, n);
+        used_ += n;
+        data += n;
+        length -= n;
+        if (used_ == buffer_.size()) flush();
+    }
+}
+
+void DungeonWriter::writeRow(const char* row, size_t length) {
+    write(row, length);
+    write("\n", 1);
+}
+
+void DungeonWriter::flush() {
+    if (used_ == 0) return;
+    emit(buffer_.data(), used_);
+    used_ = 0;
+}
+
+void DungeonWriter::emit(const char* data, size_t length) {
+    if (!ok_) return;
+    if (stream_) {
+        stream_->write(data, static_cast<streamsize>(length));
+        ok_ = static_cast<bool>(*stream_);
+    } else {
+        ok_ = writeAll(fd_, data, length);
+    }
+}
+
+DungeonReader::DungeonReader(istream& in, size_t chunkSize)
+    : stream_(&in), buffer_(max<size_t>(chunkSize, 1)) {}
+
+DungeonReader::DungeonReader(int fd, size_t chunkSize)
+    : fd_(fd), buffer_(max<size_t>(chunkSize, 1)) {}
+
+bool DungeonReader::refill() {
+    if (eof_) return false;
+    long n;
+    if (stream_) {
+        stream_->read(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+        n = static_cast<long>(stream_->gcount());
+    } else {
+        n = readSome(fd_, buffer_.data(), buffer_.size());
+    }
+    if (n <= 0) {
+        eof_ = true;
+        return false;
+    }
+    pos_ = 0;
+    end_ = static_cast<size_t>(n);
+    return true;
+}
+
+bool DungeonReader::nextRow(string& row) {
+    row.clear();
+    bool any = false;
+    for (;;) {
+        if (pos_ == end_ && !refill()) break;
+        any = true;
+        const char* begin = buffer_.data() + pos_;
+        const char* newline = static_cast<const char*>(memchr(begin, '\n', end_ - pos_));
+        if (newline) {
+            row.append(begin, newline);
+            pos_ += static_cast<size_t>(newline - begin) + 1;
+            if (!row.empty() && row.back() == '\r') row.pop_back();
+            return true;
+        }
+        row.append(begin, end_ - pos_);  // row continues in the next chunk
+        pos_ = end_;
+    }
+    if (!row.empty() && row.back() == '\r') row.pop_back();
+    return any;
+}
+
+void writeDungeon(DungeonWriter& out, const Grid& dungeon) {
+    for (int r = 0; r < dungeon.rows(); r++) {
+        out.writeRow(dungeon.data() + dungeon.index(r, 0), dungeon.cols());
+    }
+}
+
+Grid readDungeonGrid(DungeonReader& in) {
+    string row;
+    if (!in.nextRow(row) || row.empty()) return Grid(0, 0);
+
+    Grid dungeon(0, static_cast<int>(row.size()));
+    do {
+        dungeon.appendRow(row.data(), static_cast<int>(row.size()));
+    } while (in.nextRow(row) && !row.empty());
+    return dungeon;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include <cstddef>
+#include "grid.h"
+
+/**
+ * Buffered row writer for ASCII dungeons. Rows are collected into a
+ * fixed-size chunk and handed to the output in one write per chunk, instead
+ * of one flushing `cout << endl` per row.
+ */
+class DungeonWriter {
+public:
+    static const size_t DEFAULT_CHUNK = 1 << 16;
+
+    // Writes to a C++ stream
+    explicit DungeonWriter(std::ostream& out, size_t chunkSize = DEFAULT_CHUNK);
+
+    // Writes straight to a file descriptor with one write() call per chunk
+    explicit DungeonWriter(int fd, size_t chunkSize = DEFAULT_CHUNK);
+
+    // Flushes whatever is still buffered
+    ~DungeonWriter();
+
+    DungeonWriter(const DungeonWriter&) = delete;
+    DungeonWriter& operator=(const DungeonWriter&) = delete;
+
+    // Appends one row followed by a newline
+    void writeRow(const char* row, size_t length);
+    void writeRow(const std::string& row) { writeRow(row.data(), row.size()); }
+
+    // Appends raw bytes
+    void write(const char* data, size_t length);
+
+    // Sends the buffered chunk to the output
+    void flush();
+
+    // false once a write to the output has failed
+    bool ok() const { return ok_; }
+
+private:
+    void emit(const char* data, size_t length);
+
+    std::ostream* stream_ = nullptr;
+    int fd_ = -1;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+    bool ok_ = true;
+};
+
+/**
+ * Chunked row reader for ASCII dungeons: reads the input in fixed-size
+ * blocks and splits it into rows ('\n' or "\r\n" terminated).
+ */
+class DungeonReader {
+public:
+    static const size_t DEFAULT_CHUNK = 1 << 16;
+
+    explicit DungeonReader(std::istream& in, size_t chunkSize = DEFAULT_CHUNK);
+    explicit DungeonReader(int fd, size_t chunkSize = DEFAULT_CHUNK);
+
+    DungeonReader(const DungeonReader&) = delete;
+    DungeonReader& operator=(const DungeonReader&) = delete;
+
+    /**
+     * Reads the next row into row (without the line terminator).
+     * @return false at end of input
+     */
+    bool nextRow(std::string& row);
+
+private:
+    bool refill();
+
+    std::istream* stream_ = nullptr;
+    int fd_ = -1;
+    std::vector<char> buffer_;
+    size_t pos_ = 0, end_ = 0;
+    bool eof_ = false;
+};
+
+/**
+ * Writes every row of a grid through a buffered writer.
+ *
+ * @param out Destination writer
+ * @param dungeon Grid to write
+ */
+void writeDungeon(DungeonWriter& out, const Grid& dungeon);
+
+/**
+ * Reads an ASCII dungeon straight into a Grid, one row at a time, without
+ * ever building a vector<string> of the whole map. Reading stops at end of
+ * input or at the first empty line. The first row fixes the width.
+ *
+ * @param in Source reader
+ * @return Grid holding the dungeon
+ */
+Grid readDungeonGrid(DungeonReader& in);
@@ -1,17 +1,20 @@
 #include "generator.h"
+#include "rng.h"
+#include "maze_algorithms.h"
+#include "dungeon_io.h"
+#include "key_placement.h"
+#include "thread_pool.h"
 #include <vector>
 #include <string>
 #include <random>
 #include <ctime>
+#include <atomic>
 #include <algorithm>
+#include <cstdint>
+#include <memory_resource>
 
 using namespace std;
 
-// Directions: up, down, left, right — two steps to allow walls between paths
-const vector<pair<int, int>> DIRECTIONS = {
-    {-2, 0}, {2, 0}, {0, -2}, {0, 2}
-};
-
 // Helper: Check if a cell is valid and carveable
 bool isValidCell(int row, int col, int rows, int cols) {
     return row > 0 && row < rows - 1 &&
@@ -27,60 +30,485 @@ void carvePassage(vector<string>& dungeon, int fromRow, int fromCol, int toRow,
     dungeon[wallRow][wallCol] = ' ';
 }
 
-// Recursive maze generation using backtracking
-void generateMaze(vector<string>& dungeon, int row, int col, int rows, int cols, mt19937& rng) {
-    vector<pair<int, int>> dirs = DIRECTIONS;
-    shuffle(dirs.begin(), dirs.end(), rng);
+void carvePassage(Grid& dungeon, int fromRow, int fromCol, int toRow, int toCol) {
+    int wallRow = (fromRow + toRow) / 2;
+    int wallCol = (fromCol + toCol) / 2;
+    dungeon.at(toRow, toCol) = ' ';
+    dungeon.at(wallRow, wallCol) = ' ';
+}
+
+// Distances from S = (1, 1) over the maze cells (the odd (row, col)
+// cells) while a dungeon is generated. Carving fills them in for the maze;
+// once the rooms are punched, one pass lowers the cells the punched walls
+// bring closer to S. With the corner exit it stops as soon as E can get no
+// closer; otherwise it finishes and then picks E from the distances.
+class SolutionTracker {
+public:
+    SolutionTracker(const Grid& dungeon, const GeneratorOptions& options)
+        : dungeon_(dungeon), width_((dungeon.cols() - 1) / 2),
+          dist_(static_cast<size_t>(width_) * ((dungeon.rows() - 1) / 2), UNREACHED, dungeon.resource()),
+          step_{-width_, width_, -1, 1}, seeds_(dungeon.resource()), queue_(dungeon.resource()),
+          tree_(dungeon.resource()), placement_(options.exit),
+          percentile_(placement_ == ExitPlacement::Farthest ? 100 : clamp(options.exitPercentile, 0, 100)),
+          exit_(static_cast<int>(dist_.size()) - 1) {}
 
-    for (const auto& dir : dirs) {
-        int newRow = row + dir.first;
-        int newCol = col + dir.second;
+    // Per-cell depth buffer for carveBacktracker
+    uint32_t* depths() { return dist_.data(); }
 
-        if (isValidCell(newRow, newCol, rows, cols) && dungeon[newRow][newCol] == '#') {
-            carvePassage(dungeon, row, col, newRow, newCol);
-            generateMaze(dungeon, newRow, newCol, rows, cols, rng);
+    // BFS over the carved maze, for carvers that do not record depths
+    void floodMaze() {
+        dist_[0] = 0;
+        queue_.assign(1, {0, cellIndex(0)});
+        lowerQueued(-1);
+    }
+
+    // Called once the maze is complete, before any room is punched (E is
+    // not known yet unless it is the corner, so keep every maze distance)
+    void mazeDone() {
+        if (placement_ != ExitPlacement::Corner) tree_.assign(dist_.begin(), dist_.end());
+    }
+
+    /**
+     * Wall (r, c) was opened by the room pass. It joins two maze cells;
+     * if one is more than two moves further from S than the other, the
+     * wall is a shortcut and the far cell becomes a seed of the repair.
+     */
+    void punched(int r, int c) {
+        int a = r % 2 ? cellId(r, c - 1) : cellId(r - 1, c);
+        int b = r % 2 ? cellId(r, c + 1) : cellId(r + 1, c);
+        if (dist_[a] > dist_[b]) swap(a, b);
+        if (dist_[a] == UNREACHED || dist_[b] <= dist_[a] + 2) return;
+        seeds_.push_back({dist_[a] + 2, b});
+    }
+
+    /**
+     * Applies the shortcut seeds with a BFS that visits only lowered cells.
+     * Seeds are merged with the queue in distance order, so each cell is
+     * lowered at most once, and once the next key cannot improve E the
+     * rest can be left stale: every cell closer to S than E is settled.
+     */
+    void lowerShortcuts() {
+        shortcuts_ = static_cast<int>(seeds_.size());
+        sort(seeds_.begin(), seeds_.end());
+        queue_.clear();
+        if (placement_ == ExitPlacement::Corner) {
+            treeDistance_ = dist_[exit_];
+            lowerQueued(exit_);
+            return;
         }
+        lowerQueued(-1);
+        chooseExit();
+        treeDistance_ = tree_[exit_];
+        tree_ = pmr::vector<uint32_t>(dungeon_.resource());
     }
-}
 
-// Main function: generates the dungeon grid
-vector<string> generateDungeon(int rows, int cols, int roomRate) {
-    if (rows % 2 == 0) rows++;  // ensure odd size
-    if (cols % 2 == 0) cols++;
+    // Grid buffer index where E belongs (valid once the rooms are punched)
+    int exitIndex() const { return cellIndex(exit_); }
+
+    void report(DungeonSolution& solution) const {
+        int id = exit_;
+        solution.treeDistance = static_cast<int>(treeDistance_);
+        solution.shortcuts = shortcuts_;
+        solution.path.clear();
+        // In a 3x3 dungeon E overwrites S, which leaves nothing to solve
+        if (dist_[id] == UNREACHED || id == 0) {
+            solution.distance = -1;
+            return;
+        }
+        // Walk back from E to S, two moves (cell, wall) closer each step
+        uint32_t d = dist_[id];
+        solution.distance = static_cast<int>(d);
+        solution.path.resize(d + 1);
+        for (int idx = cellIndex(id); d > 0; d -= 2) {
+            solution.path[d] = dungeon_.cellAt(idx);
+            for (int dir = 0; dir < NUM_DIRECTIONS; dir++) {
+                int wall = idx + dungeon_.offset(dir);
+                if (dungeon_[wall] != '#' && dist_[id + step_[dir]] == d - 2) {
+                    solution.path[d - 1] = dungeon_.cellAt(wall);
+                    id += step_[dir];
+                    idx = wall + dungeon_.offset(dir);
+                    break;
+                }
+            }
+        }
+        solution.path[0] = dungeon_.cellAt(cellIndex(0));
+    }
+
+private:
+    static constexpr uint32_t UNREACHED = 0xFFFFFFFFu;
+
+    struct Seed {
+        uint32_t dist;
+        int cell;
+        bool operator<(const Seed& other) const { return dist < other.dist; }
+    };
+
+    // A queued maze cell with its grid buffer index
+    struct Queued {
+        int id, idx;
+    };
 
-    vector<string> dungeon(rows, string(cols, '#'));
+    int cellId(int r, int c) const { return (r / 2) * width_ + c / 2; }
+    int cellIndex(int id) const { return dungeon_.index(2 * (id / width_) + 1, 2 * (id % width_) + 1); }
 
-    mt19937 rng(static_cast<unsigned int>(time(nullptr)));
-    dungeon[1][1] = ' ';  // Start carving from top-left
+    /**
+     * Picks the maze cell at the requested percentile of distances from S,
+     * S itself excluded; among equally distant cells the last in row-major
+     * order. A histogram over distances keeps it to two passes.
+     */
+    void chooseExit() {
+        uint32_t farthest = 0;
+        for (size_t id = 1; id < dist_.size(); id++) {
+            if (dist_[id] != UNREACHED) farthest = max(farthest, dist_[id]);
+        }
+        pmr::vector<uint32_t> count(farthest / 2 + 1, 0, dungeon_.resource());
+        size_t cells = 0;
+        for (size_t id = 1; id < dist_.size(); id++) {
+            if (dist_[id] == UNREACHED) continue;
+            count[dist_[id] / 2]++;
+            cells++;
+        }
+        if (cells == 0) return;  // only S: keep the corner
 
-    generateMaze(dungeon, 1, 1, rows, cols, rng);
+        size_t rank = (static_cast<size_t>(percentile_) * (cells - 1) + 50) / 100;
+        uint32_t target = 0;
+        for (size_t below = 0; below + count[target] <= rank; target++) below += count[target];
+        for (size_t id = dist_.size() - 1; id > 0; id--) {
+            if (dist_[id] == 2 * target) {
+                exit_ = static_cast<int>(id);
+                return;
+            }
+        }
+    }
 
-    // Add extra rooms based on roomRate percentage
-    int totalCells = ((rows - 1) / 2) * ((cols - 1) / 2);
-    int extraRooms = totalCells * roomRate / 100;
+    // BFS from the queued cells and the pending seeds, taking whichever is
+    // closer to S next. Stops once nothing left can lower goal (-1: none).
+    void lowerQueued(int goal) {
+        size_t head = 0, next = 0;
+        while (head < queue_.size() || next < seeds_.size()) {
+            int id, idx;
+            if (next < seeds_.size() && (head == queue_.size() || seeds_[next].dist <= dist_[queue_[head].id])) {
+                const Seed& seed = seeds_[next++];
+                if (seed.dist >= dist_[seed.cell]) continue;
+                id = seed.cell;
+                idx = cellIndex(id);
+                dist_[id] = seed.dist;
+            } else {
+                id = queue_[head].id;
+                idx = queue_[head++].idx;
+            }
+            uint32_t cost = dist_[id] + 2;
+            if (goal >= 0 && cost >= dist_[goal]) break;
+            for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                int wall = idx + dungeon_.offset(d);
+                int neighbor = id + step_[d];
+                if (dungeon_[wall] != '#' && cost < dist_[neighbor]) {
+                    dist_[neighbor] = cost;
+                    queue_.push_back({neighbor, wall + dungeon_.offset(d)});
+                }
+            }
+        }
+        seeds_.clear();
+    }
+
+    const Grid& dungeon_;
+    int width_;
+    pmr::vector<uint32_t> dist_;
+    int step_[NUM_DIRECTIONS];   // maze-cell id offset per direction
+    pmr::vector<Seed> seeds_;
+    pmr::vector<Queued> queue_;
+    pmr::vector<uint32_t> tree_;   // maze distances, while E is still to be chosen
+    ExitPlacement placement_;
+    int percentile_;
+    int exit_;                     // maze cell of E: the bottom-right one unless chosen
+    uint32_t treeDistance_ = UNREACHED;
+    int shortcuts_ = 0;
+};
 
-    for (int i = 0; i < extraRooms; ++i) {
-        int r = rng() % rows;
-        int c = rng() % cols;
-        if (dungeon[r][c] == '#' && r % 2 == 1 && c % 2 == 1) {
-            dungeon[r][c] = ' ';
+// Punches extra openings into the maze so it has loops and open areas
+// (see RoomPuncher: exactly roomRate% of the cell count, no rejections)
+template <typename Rng>
+static void addRandomRooms(Grid& dungeon, int roomRate, Rng& rng, SolutionTracker* tracker) {
+    RoomPuncher<Rng> puncher(dungeon.rows(), dungeon.cols(), roomRate, rng);
+    for (int r = 0; r < dungeon.rows(); r++) {
+        if (!tracker) {
+            puncher.punchRow(&dungeon.at(r, 0), r, dungeon.cols());
+            continue;
         }
+        puncher.punchRow(&dungeon.at(r, 0), r, dungeon.cols(), [&](int c) {
+            tracker->punched(r, c);
+        });
     }
+    if (tracker) tracker->lowerShortcuts();
+}
 
-    // Place start 'S' and exit 'E'
-    dungeon[1][1] = 'S';
+// Places start 'S' top-left and exit 'E' at the last open cell scanning
+// from the bottom right, or where the tracker chose it
+static void placeStartAndExit(Grid& dungeon, const SolutionTracker* tracker) {
+    const int rows = dungeon.rows(), cols = dungeon.cols();
+    dungeon.at(1, 1) = 'S';
+    if (tracker) {
+        dungeon[tracker->exitIndex()] = 'E';
+        return;
+    }
 
-    // Find a suitable place for 'E' (searching from bottom right)
     for (int r = rows - 2; r > 0; --r) {
         for (int c = cols - 2; c > 0; --c) {
-            if (dungeon[r][c] == ' ') {
-                dungeon[r][c] = 'E';
-                return dungeon;
+            if (dungeon.at(r, c) == ' ') {
+                dungeon.at(r, c) = 'E';
+                return;
             }
         }
     }
 
     // Fallback exit placement
-    dungeon[rows - 2][cols - 2] = 'E';
+    dungeon.at(rows - 2, cols - 2) = 'E';
+}
+
+// Generator dimensions are odd and at least 3x3
+static void normalizeSize(int& rows, int& cols) {
+    if (rows % 2 == 0) rows++;  // ensure odd size
+    if (cols % 2 == 0) cols++;
+    rows = max(rows, 3);
+    cols = max(cols, 3);
+}
+
+// Eller's algorithm with the room and S/E passes applied row by row, so the
+// whole dungeon never has to be in memory. sink(row, r) receives each
+// finished row. Every open odd/odd cell means the bottom-right scan of
+// placeStartAndExit always stops at (rows - 2, cols - 2), so placing E
+// there directly gives the same dungeon as the in-memory path.
+// onPunch(r, c) is told about each punched wall.
+template <typename Rng, typename Sink, typename OnPunch>
+static void produceEllerRows(int rows, int cols, const GeneratorOptions& options, Rng& rng,
+                             Sink&& sink, OnPunch&& onPunch) {
+    EllerRows<Rng> maze(rows, cols, rng);
+    RoomPuncher<Rng> puncher(rows, cols, options.roomRate, rng);
+    string row;
+    for (int r = 0; maze.next(row); r++) {
+        puncher.punchRow(&row[0], r, cols, [&](int c) { onPunch(r, c); });
+        if (r == 1) row[1] = 'S';
+        if (r == rows - 2) row[cols - 2] = 'E';
+        sink(row, r);
+    }
+}
+
+// Eller's rows into a grid. Rooms are punched while the maze is still
+// being produced, so for a tracker the punched walls are closed again
+// while the maze is flooded, then reopened as shortcuts.
+template <typename Rng>
+static void carveEllerDungeon(Grid& dungeon, const GeneratorOptions& options, Rng& rng,
+                              SolutionTracker* tracker) {
+    pmr::vector<Cell> punched(dungeon.resource());
+    produceEllerRows(dungeon.rows(), dungeon.cols(), options, rng, [&dungeon](const string& row, int r) {
+        copy(row.begin(), row.end(), &dungeon.at(r, 0));
+    }, [&](int r, int c) {
+        if (tracker) punched.push_back(Cell(r, c));
+    });
+    if (!tracker) return;
+
+    for (const Cell& wall : punched) dungeon.at(wall.r, wall.c) = '#';
+    tracker->floodMaze();
+    tracker->mazeDone();
+    for (const Cell& wall : punched) {
+        dungeon.at(wall.r, wall.c) = ' ';
+        tracker->punched(wall.r, wall.c);
+    }
+    tracker->lowerShortcuts();
+    dungeon.at(dungeon.rows() - 2, dungeon.cols() - 2) = ' ';
+    dungeon.at(1, 1) = 'S';
+    dungeon[tracker->exitIndex()] = 'E';
+}
+
+// Carves the maze with the chosen algorithm into an all-wall grid of
+// normalized size, then runs the shared room and S/E placement passes.
+// A tracker, if given, follows distances from S throughout.
+template <typename Rng>
+static void carveTracked(Grid& dungeon, const GeneratorOptions& options, Rng& rng,
+                         SolutionTracker* tracker) {
+    switch (options.algorithm) {
+    case MazeAlgorithm::Eller:
+        carveEllerDungeon(dungeon, options, rng, tracker);
+        return;
+    case MazeAlgorithm::Kruskal:
+        carveKruskal(dungeon, rng);
+        if (tracker) tracker->floodMaze();
+        break;
+    case MazeAlgorithm::Wilson:
+        carveWilson(dungeon, rng);
+        if (tracker) tracker->floodMaze();
+        break;
+    case MazeAlgorithm::Backtracker:
+    default:
+        carveBacktracker(dungeon, rng, tracker ? tracker->depths() : nullptr);
+        break;
+    }
+
+    if (tracker) tracker->mazeDone();
+    addRandomRooms(dungeon, options.roomRate, rng, tracker);
+    placeStartAndExit(dungeon, tracker);
+}
+
+// LevelIndex of a freshly carved dungeon without scanning it: every maze
+// cell and the cells - 1 passages between them are open, plus the punched
+// walls. S is at (1, 1) unless E overwrote it (3x3).
+static void indexPlaced(const Grid& dungeon, int roomRate, int exitIndex, LevelIndex& level) {
+    int64_t width = (dungeon.cols() - 1) / 2, height = (dungeon.rows() - 1) / 2;
+    int start = dungeon.index(1, 1);
+    level.start = start == exitIndex ? -1 : start;
+    level.goal = exitIndex;
+    level.openCells = static_cast<int>(2 * width * height - 1 + roomsToPunch(dungeon.rows(), dungeon.cols(), roomRate));
+    level.keys.clear();
+    level.doors.clear();
+}
+
+// carveTracked with a tracker only when distances are needed (to report
+// the solution or to place E by distance), then the keys and doors
+template <typename Rng>
+static void carveDungeon(Grid& dungeon, const GeneratorOptions& options, Rng& rng,
+                         DungeonSolution* solution = nullptr) {
+    if (!solution && options.exit == ExitPlacement::Corner) {
+        carveTracked(dungeon, options, rng, nullptr);
+    } else {
+        SolutionTracker tracker(dungeon, options);
+        carveTracked(dungeon, options, rng, &tracker);
+        if (solution) {
+            tracker.report(*solution);
+            indexPlaced(dungeon, options.roomRate, tracker.exitIndex(), solution->level);
+        }
+    }
+    if (options.keys <= 0) return;
+
+    // Drawn after everything else, so the walls, S and E do not depend on keys
+    uint64_t seed = rng();
+    seed = (seed << 32) ^ rng();
+    KeyPlacement placed = placeKeysAndDoors(dungeon, options.keys, options.requiredKeys, seed);
+    if (solution) {
+        solution->keys = placed.pairs;
+        solution->requiredKeys = placed.required;
+        solution->level.keys.assign(placed.keyCells.begin(), placed.keyCells.end());
+        solution->level.doors.assign(placed.doorCells.begin(), placed.doorCells.end());
+    }
+}
+
+template <typename Rng>
+static Grid buildDungeon(int rows, int cols, const GeneratorOptions& options, Rng& rng,
+                         pmr::memory_resource* resource) {
+    normalizeSize(rows, cols);
+    Grid dungeon(rows, cols, '#', resource);
+    carveDungeon(dungeon, options, rng);
     return dungeon;
 }
+
+template <typename Rng>
+static void streamWithRng(DungeonWriter& out, int rows, int cols, const GeneratorOptions& options,
+                          Rng& rng) {
+    if (options.algorithm != MazeAlgorithm::Eller || options.exit != ExitPlacement::Corner || options.keys > 0) {
+        writeDungeon(out, buildDungeon(rows, cols, options, rng, pmr::get_default_resource()));
+        return;
+    }
+    normalizeSize(rows, cols);
+    produceEllerRows(rows, cols, options, rng, [&out](const string& row, int) {
+        out.writeRow(row);
+    }, [](int, int) {});
+}
+
+// Runs fn with the generator selected by options.engine
+template <typename Fn>
+static auto withEngine(const GeneratorOptions& options, Fn&& fn) {
+    switch (options.engine) {
+    case RngEngine::MersenneTwister: {
+        // Fold the seed to 32 bits; seeds below 2^32 match the old generator
+        mt19937 rng(static_cast<uint32_t>(options.seed ^ (options.seed >> 32)));
+        return fn(rng);
+    }
+    case RngEngine::Xoshiro256:
+    default: {
+        Xoshiro256 rng(options.seed);
+        return fn(rng);
+    }
+    }
+}
+
+// Main function: generates the dungeon grid
+Grid generateDungeonGrid(int rows, int cols, const GeneratorOptions& options,
+                         pmr::memory_resource* resource) {
+    return withEngine(options, [&](auto& rng) {
+        return buildDungeon(rows, cols, options, rng, resource);
+    });
+}
+
+Grid generateDungeonGrid(int rows, int cols, const GeneratorOptions& options, DungeonSolution& solution) {
+    normalizeSize(rows, cols);
+    Grid dungeon(rows, cols, '#');
+    withEngine(options, [&](auto& rng) { carveDungeon(dungeon, options, rng, &solution); });
+    return dungeon;
+}
+
+bool streamDungeon(DungeonWriter& out, int rows, int cols, const GeneratorOptions& options) {
+    withEngine(options, [&](auto& rng) { streamWithRng(out, rows, cols, options, rng); });
+    out.flush();
+    return out.ok();
+}
+
+bool streamDungeon(ostream& out, int rows, int cols, const GeneratorOptions& options) {
+    DungeonWriter writer(out);
+    return streamDungeon(writer, rows, cols, options);
+}
+
+uint64_t batchSeed(uint64_t baseSeed, uint64_t index) {
+    // The index-th output of SplitMix64(baseSeed), computed directly
+    return SplitMix64(baseSeed + index * 0x9E3779B97F4A7C15ull)();
+}
+
+vector<Grid> generateDungeons(size_t count, int rows, int cols, const GeneratorOptions& options,
+                              int threads) {
+    // Every grid is allocated up front, so workers only carve in place
+    normalizeSize(rows, cols);
+    vector<Grid> dungeons(count, Grid(rows, cols));
+
+    ThreadPool pool(threads > 0 ? threads : solverThreads());
+    pool.parallelForStealing(count, [&](size_t index, int) {
+        GeneratorOptions job = options;
+        job.seed = batchSeed(options.seed, index);
+        withEngine(job, [&](auto& rng) { carveDungeon(dungeons[index], job, rng); });
+    });
+    return dungeons;
+}
+
+vector<Grid> generateDungeons(size_t count, int rows, int cols, int roomRate, uint64_t baseSeed,
+                              int threads) {
+    GeneratorOptions options;
+    options.roomRate = roomRate;
+    options.seed = baseSeed;
+    return generateDungeons(count, rows, cols, options, threads);
+}
+
+vector<string> generateDungeon(int rows, int cols, const GeneratorOptions& options) {
+    return generateDungeonGrid(rows, cols, options).toStrings();
+}
+
+pmr::vector<pmr::string> generateDungeon(int rows, int cols, const GeneratorOptions& options,
+                                         pmr::memory_resource* resource) {
+    return generateDungeonGrid(rows, cols, options, resource).toStrings(resource);
+}
+
+uint64_t randomSeed() {
+    // Mix entropy, the clock and a call counter so back-to-back calls differ
+    static atomic<uint64_t> calls(0);
+    random_device device;
+    uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+    seed ^= static_cast<uint64_t>(time(nullptr)) * 0x9E3779B97F4A7C15ull;
+    return SplitMix64(seed + calls.fetch_add(1))();
+}
+
+Grid generateDungeonGrid(int rows, int cols, int roomRate) {
+    GeneratorOptions options;
+    options.roomRate = roomRate;
+    options.seed = randomSeed();
+    return generateDungeonGrid(rows, cols, options);
+}
+
+vector<string> generateDungeon(int rows, int cols, int roomRate) {
+    return generateDungeonGrid(rows, cols, roomRate).toStrings();
+}
@@ -1,6 +1,15 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
+#include <memory_resource>
+#include "cell.h"
+#include "grid.h"
+#include "level_index.h"
+
+class DungeonWriter;
 
 /**
  * Generates a random dungeon using recursive backtracking algorithm.
@@ -15,6 +24,174 @@
  */
 std::vector<std::string> generateDungeon(int rows, int cols, int roomRate = 20);
 
+/**
+ * Pseudo-random generators the dungeon generator can use.
+ */
+enum class RngEngine {
+    Xoshiro256,      // fast, 32-byte state (default; see rng.h)
+    MersenneTwister  // std::mt19937, the original generator's engine
+};
+
+/**
+ * Maze carving algorithms. All produce a perfect maze and share the same
+ * room punching and S/E placement, so they are interchangeable inputs for
+ * the solvers (see maze_algorithms.h).
+ */
+enum class MazeAlgorithm {
+    Backtracker,  // depth-first backtracking: long corridors, few branches
+    Eller,        // row by row in O(cols) memory; can be streamed
+    Kruskal,      // randomized Kruskal with a flat union-find: many short branches
+    Wilson        // loop-erased random walks: uniform spanning tree
+};
+
+/**
+ * Where the generator puts the exit. The modes other than Corner pick a
+ * maze cell (odd row and column) by its distance from S once the rooms are
+ * punched, which sets the level's difficulty without moving any wall.
+ */
+enum class ExitPlacement {
+    Corner,      // last open cell scanning back from the bottom right (original)
+    Farthest,    // the cell farthest from S
+    Percentile   // the cell at exitPercentile of the cells' distances from S
+};
+
+/**
+ * Settings for a reproducible generateDungeon call. The same options and
+ * dimensions always produce the same dungeon.
+ */
+struct GeneratorOptions {
+    int roomRate = 20;                        // percentage of extra rooms to punch
+    uint64_t seed = 0;                        // 64-bit seed for the generator
+    RngEngine engine = RngEngine::Xoshiro256; // which PRNG to draw from
+    MazeAlgorithm algorithm = MazeAlgorithm::Backtracker;
+    ExitPlacement exit = ExitPlacement::Corner;
+    int exitPercentile = 100;                 // 0-100, for ExitPlacement::Percentile
+    int keys = 0;                             // key/door pairs to place (0-5, see key_placement.h)
+    int requiredKeys = -1;                    // pairs that must be picked up; -1 = drawn from the seed
+};
+
+/**
+ * Deterministic generateDungeon: seeded explicitly through options, so a
+ * level can be regenerated later from its seed.
+ *
+ * @param rows Number of rows in the dungeon (should be odd for proper maze)
+ * @param cols Number of columns in the dungeon (should be odd for proper maze)
+ * @param options Room rate, seed and PRNG engine
+ * @return 2D dungeon represented as vector of strings (same tiles as generateDungeon)
+ */
+std::vector<std::string> generateDungeon(int rows, int cols, const GeneratorOptions& options);
+Grid generateDungeonGrid(int rows, int cols, const GeneratorOptions& options,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+/**
+ * Solution facts recorded while a dungeon is generated, so a pipeline that
+ * only needs to confirm and score a level does not have to run bfsPath.
+ */
+struct DungeonSolution {
+    int distance = -1;        // moves from S to E with doors as floor (bfsDistance before keys were placed)
+    int treeDistance = -1;    // moves from S to E through the maze before rooms were punched
+    int shortcuts = 0;        // punched walls joining cells more than two moves apart from S
+    int keys = 0;             // key/door pairs placed
+    int requiredKeys = 0;     // of those, doors on every route from S to E
+    std::vector<Cell> path;   // a shortest path from S to E with doors as floor (may cross locked doors)
+    LevelIndex level;         // indexLevel of the dungeon, from what the generator placed
+};
+
+/**
+ * generateDungeonGrid that also reports the S-to-E distance and path.
+ *
+ * S is the backtracker's root, so its carving depth is already the maze
+ * distance from S; it is stored per maze cell as passages are carved.
+ * Punched room walls that open a shortcut then seed one BFS that visits
+ * only the cells they bring closer, and only until E is settled. The other
+ * algorithms do not know depths while carving and flood the maze once
+ * before the rooms instead. With an ExitPlacement other than Corner the
+ * repair runs to completion, since E is chosen from all the distances.
+ * Keys and doors are placed last, and the distance and path ignore them.
+ * The level index is filled from the positions of S, E, the keys and the
+ * doors and the number of walls punched, without scanning the dungeon.
+ * The dungeon is the same one generateDungeonGrid returns for these options.
+ *
+ * @param rows Number of rows in the dungeon (should be odd for proper maze)
+ * @param cols Number of columns in the dungeon (should be odd for proper maze)
+ * @param options Room rate, seed, PRNG engine and maze algorithm
+ * @param solution Receives the distance, tree distance and path
+ * @return Generated dungeon as a Grid
+ */
+Grid generateDungeonGrid(int rows, int cols, const GeneratorOptions& options, DungeonSolution& solution);
+
+/**
+ * generateDungeon with the rows, the working grid and the carving scratch
+ * allocated from resource, so one arena per request can be dropped at once.
+ *
+ * @param rows Number of rows in the dungeon (should be odd for proper maze)
+ * @param cols Number of columns in the dungeon (should be odd for proper maze)
+ * @param options Room rate, seed, PRNG engine and maze algorithm
+ * @param resource Memory resource for the result and temporaries
+ * @return Same tiles as generateDungeon(rows, cols, options)
+ */
+std::pmr::vector<std::pmr::string> generateDungeon(int rows, int cols, const GeneratorOptions& options,
+                                                   std::pmr::memory_resource* resource);
+
+/**
+ * Generates a dungeon straight into a writer. With MazeAlgorithm::Eller,
+ * ExitPlacement::Corner and no keys the maze, rooms and S/E are produced
+ * one row at a time, so memory stays O(cols) whatever the height;
+ * otherwise the grid is built first.
+ * Writes exactly the rows generateDungeon returns for the same options.
+ *
+ * @param out Destination writer (see dungeon_io.h); flushed before returning
+ * @param rows Number of rows in the dungeon (should be odd for proper maze)
+ * @param cols Number of columns in the dungeon (should be odd for proper maze)
+ * @param options Room rate, seed, PRNG engine and maze algorithm
+ * @return false if writing to the output failed
+ */
+bool streamDungeon(DungeonWriter& out, int rows, int cols, const GeneratorOptions& options);
+bool streamDungeon(std::ostream& out, int rows, int cols, const GeneratorOptions& options);
+
+/**
+ * Seed of job index in a batch generated from baseSeed: the index-th output
+ * of SplitMix64(baseSeed), so neighboring jobs get unrelated streams.
+ * generateDungeonGrid with this seed regenerates that one level.
+ */
+uint64_t batchSeed(uint64_t baseSeed, uint64_t index);
+
+/**
+ * Generates count dungeons in parallel. Job i is generateDungeonGrid with
+ * options.seed replaced by batchSeed(options.seed, i), carved into a grid
+ * allocated before the workers start. Jobs are spread over a work-stealing
+ * pool; since each job owns its RNG stream and its grid, the output is
+ * bit-identical for any thread count.
+ *
+ * @param count Number of dungeons
+ * @param rows Number of rows in each dungeon (should be odd for proper maze)
+ * @param cols Number of columns in each dungeon (should be odd for proper maze)
+ * @param options Generator settings; seed is the batch's base seed
+ * @param threads Worker threads (0 = solverThreads())
+ * @return The dungeons, in job order
+ */
+std::vector<Grid> generateDungeons(size_t count, int rows, int cols, const GeneratorOptions& options,
+                                   int threads = 0);
+std::vector<Grid> generateDungeons(size_t count, int rows, int cols, int roomRate, uint64_t baseSeed,
+                                   int threads = 0);
+
+/**
+ * Returns a fresh non-deterministic seed. generateDungeon(rows, cols, roomRate)
+ * uses it, so back-to-back calls produce different dungeons.
+ */
+uint64_t randomSeed();
+
+/**
+ * Same as generateDungeon, but returns the flat Grid used internally by the
+ * generator and solvers, skipping the conversion to vector<string>.
+ *
+ * @param rows Number of rows in the dungeon (should be odd for proper maze)
+ * @param cols Number of columns in the dungeon (should be odd for proper maze)
+ * @param roomRate Percentage (0-100) of additional rooms to punch after maze generation
+ * @return Generated dungeon as a Grid
+ */
+Grid generateDungeonGrid(int rows, int cols, int roomRate = 20);
+
 /**
  * Helper function to check if a cell coordinate is valid within the dungeon bounds
  * and represents a carveable cell (odd coordinates in a perfect maze).
@@ -37,4 +214,15 @@ bool isValidCell(int row, int col, int rows, int cols);
  * @param toRow Target cell row
  * @param toCol Target cell column
  */
-void carvePassage(std::vector<std::string>& dungeon, int fromRow, int fromCol, int toRow, int toCol);
\ No newline at end of file
+void carvePassage(std::vector<std::string>& dungeon, int fromRow, int fromCol, int toRow, int toCol);
+
+/**
+ * Grid overload of carvePassage, used by the generator itself.
+ *
+ * @param dungeon The dungeon grid to modify
+ * @param fromRow Starting cell row
+ * @param fromCol Starting cell column
+ * @param toRow Target cell row
+ * @param toCol Target cell column
+ */
+void carvePassage(Grid& dungeon, int fromRow, int fromCol, int toRow, int toCol);
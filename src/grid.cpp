@@ -0,0 +1,66 @@
+#include "grid.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+Grid::Grid(int rows, int cols, char fill, pmr::memory_resource* resource)
+    : rows_(max(rows, 0)), cols_(max(cols, 0)), stride_(max(cols, 0) + 2),
+      tiles_(static_cast<size_t>(max(rows, 0) + 2) * (max(cols, 0) + 2), '#', resource) {
+    if (fill == '#') return;
+    for (int r = 0; r < rows_; r++) {
+        fill_n(tiles_.begin() + index(r, 0), cols_, fill);
+    }
+}
+
+Grid Grid::fromStrings(const vector<string>& dungeon, pmr::memory_resource* resource) {
+    Grid grid(0, 0, '#', resource);
+    grid.assign(dungeon);
+    return grid;
+}
+
+Grid Grid::fromStrings(const pmr::vector<pmr::string>& dungeon, pmr::memory_resource* resource) {
+    Grid grid(0, 0, '#', resource);
+    grid.assign(dungeon);
+    return grid;
+}
+
+// Copies every row out of the border-padded buffer
+template <typename Rows>
+static Rows copyRows(const Grid& grid, Rows rows) {
+    rows.reserve(grid.rows());
+    for (int r = 0; r < grid.rows(); r++) {
+        const char* begin = grid.data() + grid.index(r, 0);
+        rows.emplace_back(begin, begin + grid.cols());
+    }
+    return rows;
+}
+
+vector<string> Grid::toStrings() const {
+    return copyRows(*this, vector<string>());
+}
+
+pmr::vector<pmr::string> Grid::toStrings(pmr::memory_resource* resource) const {
+    return copyRows(*this, pmr::vector<pmr::string>(resource));
+}
+
+void Grid::appendRow(const char* row, int length) {
+    // The last stride_ tiles are the bottom border: turn them into the new
+    // row's slot and add a fresh border after it
+    size_t slot = tiles_.size() - stride_;
+    tiles_.resize(tiles_.size() + stride_, '#');
+    copy(row, row + min(length, cols_), tiles_.begin() + slot + 1);
+    rows_++;
+}
+
+int Grid::find(char target) const {
+    // Scan row by row so the wall border never matches
+    for (int r = 0; r < rows_; r++) {
+        const char* begin = tiles_.data() + index(r, 0);
+        const void* hit = memchr(begin, target, cols_);
+        if (hit) return static_cast<int>(static_cast<const char*>(hit) - tiles_.data());
+    }
+    return -1;
+}
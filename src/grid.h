@@ -0,0 +1,136 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory_resource>
+#include <algorithm>
+#include "cell.h"
+
+/**
+ * Contiguous dungeon grid used internally by the generator and the solvers.
+ *
+ * All tiles live in one buffer with a fixed row stride. The buffer is padded
+ * with a one-tile wall border on every side, so the four neighbors of any
+ * in-bounds tile are always valid buffer indices and a search never needs a
+ * bounds check: stepping off the map simply lands on a '#'.
+ *
+ * Tiles are addressed either by (row, col) in dungeon coordinates or by
+ * their linear buffer index; index(), row() and col() convert between them.
+ *
+ * The buffer is allocated from a std::pmr::memory_resource (the default
+ * heap unless one is given), so a dungeon can live in a caller's arena.
+ */
+class Grid {
+public:
+    Grid() = default;
+
+    /**
+     * Creates a rows x cols grid with every tile set to fill.
+     *
+     * @param rows Number of rows in the dungeon
+     * @param cols Number of columns in the dungeon
+     * @param fill Character used for every tile (defaults to wall)
+     * @param resource Memory resource for the tile buffer
+     */
+    Grid(int rows, int cols, char fill = '#',
+         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * Builds a grid from the vector<string> form used by the public API.
+     * Rows shorter than the widest row are padded with walls.
+     *
+     * @param dungeon 2D grid represented as vector of strings
+     * @param resource Memory resource for the tile buffer
+     * @return Grid holding a copy of the dungeon
+     */
+    static Grid fromStrings(const std::vector<std::string>& dungeon,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    static Grid fromStrings(const std::pmr::vector<std::pmr::string>& dungeon,
+                            std::pmr::memory_resource* resource);
+
+    /**
+     * Replaces the contents with a copy of dungeon, like fromStrings, but
+     * reuses the existing buffer when it is large enough.
+     *
+     * @param dungeon Rows of the dungeon (any container of strings)
+     */
+    template <typename Rows>
+    void assign(const Rows& dungeon) {
+        size_t width = 0;
+        for (const auto& row : dungeon) width = std::max(width, row.size());
+
+        rows_ = static_cast<int>(dungeon.size());
+        cols_ = static_cast<int>(width);
+        stride_ = cols_ + 2;
+        tiles_.assign(static_cast<size_t>(rows_ + 2) * stride_, '#');
+        int r = 0;
+        for (const auto& row : dungeon) {
+            std::copy(row.begin(), row.end(), tiles_.begin() + index(r++, 0));
+        }
+    }
+
+    /**
+     * Converts the grid back to the vector<string> form (border not included).
+     *
+     * @return One string per dungeon row
+     */
+    std::vector<std::string> toStrings() const;
+    std::pmr::vector<std::pmr::string> toStrings(std::pmr::memory_resource* resource) const;
+
+    // Memory resource the tile buffer is allocated from
+    std::pmr::memory_resource* resource() const { return tiles_.get_allocator().resource(); }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    // Distance in the buffer between vertically adjacent tiles
+    int stride() const { return stride_; }
+
+    // Total buffer size including the wall border
+    int size() const { return static_cast<int>(tiles_.size()); }
+
+    // Linear buffer index of dungeon position (row, col)
+    int index(int row, int col) const { return (row + 1) * stride_ + (col + 1); }
+    int index(const Cell& cell) const { return index(cell.r, cell.c); }
+
+    // Dungeon row / column of a linear buffer index
+    int row(int idx) const { return idx / stride_ - 1; }
+    int col(int idx) const { return idx % stride_ - 1; }
+    Cell cellAt(int idx) const { return Cell(row(idx), col(idx)); }
+
+    // Buffer offset of one step in direction d (see DIRECTIONS in cell.h)
+    int offset(int d) const { return DIRECTIONS[d][0] * stride_ + DIRECTIONS[d][1]; }
+
+    bool inBounds(int row, int col) const {
+        return row >= 0 && row < rows_ && col >= 0 && col < cols_;
+    }
+
+    char at(int row, int col) const { return tiles_[index(row, col)]; }
+    char& at(int row, int col) { return tiles_[index(row, col)]; }
+
+    char operator[](int idx) const { return tiles_[idx]; }
+    char& operator[](int idx) { return tiles_[idx]; }
+
+    const char* data() const { return tiles_.data(); }
+
+    /**
+     * Appends a row at the bottom of the grid, keeping the wall border.
+     * The row is truncated or wall-padded to cols(). Lets readers build a
+     * grid row by row when the row count is not known up front.
+     *
+     * @param row Tiles of the new row
+     * @param length Number of characters in row
+     */
+    void appendRow(const char* row, int length);
+
+    /**
+     * Finds the first tile (in row-major order) equal to target.
+     *
+     * @param target The character to find
+     * @return Linear buffer index of the tile, or -1 if not found
+     */
+    int find(char target) const;
+
+private:
+    int rows_ = 0, cols_ = 0, stride_ = 2;
+    std::pmr::vector<char> tiles_;
+};
@@ -0,0 +1,27 @@
+#include "grid_layout.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+GridLayout chooseLayout(const Grid& dungeon, GridLayout layout) {
+    if (layout != GridLayout::Auto) return layout;
+    return dungeon.size() >= TILED_LAYOUT_MIN_TILES ? GridLayout::Tiled : GridLayout::RowMajor;
+}
+
+TiledGrid::TiledGrid(const Grid& dungeon, pmr::memory_resource* resource)
+    : stride_(dungeon.stride()), tiles_(resource) {
+    const int paddedRows = dungeon.rows() + 2;
+    const int blockRows = (paddedRows + BLOCK - 1) / BLOCK;
+    blockCols_ = (stride_ + BLOCK - 1) / BLOCK;
+    blockRowTiles_ = blockCols_ * BLOCK_TILES;
+    tiles_.assign(static_cast<size_t>(blockRows) * blockRowTiles_, '#');
+
+    // Each padded row is split into 64-tile runs, one per block it crosses
+    for (int r = 0; r < paddedRows; r++) {
+        const char* row = dungeon.data() + static_cast<size_t>(r) * stride_;
+        for (int c = 0; c < stride_; c += BLOCK) {
+            memcpy(&tiles_[paddedIndex(r, c)], row + c, min(BLOCK, stride_ - c));
+        }
+    }
+}
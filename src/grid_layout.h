@@ -0,0 +1,127 @@
+#pragma once
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+
+/**
+ * Memory layouts a solver can search a dungeon in. Paths and every public
+ * API stay in Cell coordinates; a layout only changes how the solver's own
+ * copy of the tiles and its per-cell visited and parent arrays are indexed.
+ */
+enum class GridLayout {
+    Auto,      // chooseLayout picks one from the grid size
+    RowMajor,  // the Grid buffer itself, one row after another
+    Tiled      // 64x64 blocks of one 4 KiB page each (see TiledGrid)
+};
+
+/**
+ * Auto resolves to Tiled from this many buffer tiles up (about 2900 x
+ * 2900). Below it the rows of the BFS wavefront stay in cache and row-major
+ * indexing is cheaper than copying the grid.
+ */
+const int TILED_LAYOUT_MIN_TILES = 1 << 23;
+
+/**
+ * Resolves GridLayout::Auto for a dungeon; other layouts are returned as is.
+ *
+ * @param dungeon The dungeon to search
+ * @param layout Requested layout
+ * @return RowMajor or Tiled
+ */
+GridLayout chooseLayout(const Grid& dungeon, GridLayout layout = GridLayout::Auto);
+
+/**
+ * Row-major layout: a view of the Grid buffer with the interface TiledGrid
+ * has, so a search can be written once for both. Indices are Grid indices.
+ */
+class RowMajorLayout {
+public:
+    explicit RowMajorLayout(const Grid& dungeon) : dungeon_(dungeon) {}
+
+    int size() const { return dungeon_.size(); }
+    char operator[](int idx) const { return dungeon_[idx]; }
+
+    // Layout index of the tile at Grid index gridIdx
+    int fromGrid(int gridIdx) const { return gridIdx; }
+    Cell cellAt(int idx) const { return dungeon_.cellAt(idx); }
+
+    // Index one step from idx in direction d (see DIRECTIONS in cell.h)
+    int neighbor(int idx, int d) const { return idx + dungeon_.offset(d); }
+
+    // Index dr rows and dc columns (-1, 0 or 1 each) away from idx
+    int step(int idx, int dr, int dc) const { return idx + dr * dungeon_.stride() + dc; }
+
+private:
+    const Grid& dungeon_;
+};
+
+/**
+ * Copy of a dungeon in square blocks of 64 x 64 tiles, each block one
+ * 4 KiB page, row-major inside the block and blocks row-major in the
+ * buffer. On a row-major 8k x 8k map every vertical step lands on another
+ * page; here 63 of 64 stay on the same page, and the visited bits and
+ * parent directions indexed the same way follow along. The Grid's wall
+ * border is copied too, and the last blocks are padded with walls, so a
+ * step from any dungeon tile is still a valid index.
+ */
+class TiledGrid {
+public:
+    static constexpr int BLOCK_BITS = 6;
+    static constexpr int BLOCK = 1 << BLOCK_BITS;  // tiles per block side
+    static constexpr int BLOCK_TILES = BLOCK * BLOCK;
+
+    /**
+     * Copies dungeon into blocks, 64 tiles of a row at a time.
+     *
+     * @param dungeon The dungeon to copy
+     * @param resource Memory resource for the tile buffer
+     */
+    explicit TiledGrid(const Grid& dungeon,
+                       std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    int size() const { return static_cast<int>(tiles_.size()); }
+    char operator[](int idx) const { return tiles_[idx]; }
+
+    // Layout index of the tile at Grid index gridIdx
+    int fromGrid(int gridIdx) const { return paddedIndex(gridIdx / stride_, gridIdx % stride_); }
+    Cell cellAt(int idx) const {
+        int block = idx >> (2 * BLOCK_BITS);
+        int r = (block / blockCols_) * BLOCK + ((idx >> BLOCK_BITS) & (BLOCK - 1));
+        int c = (block % blockCols_) * BLOCK + (idx & (BLOCK - 1));
+        return Cell(r - 1, c - 1);
+    }
+
+    // Index one step from idx in direction d; crossing a block edge moves
+    // to the neighboring block (up, down, left, right as in DIRECTIONS)
+    int neighbor(int idx, int d) const {
+        const int rowBits = (BLOCK - 1) << BLOCK_BITS, colBits = BLOCK - 1;
+        switch (d) {
+        case 0: return (idx & rowBits) != 0 ? idx - BLOCK : idx - blockRowTiles_ + rowBits;
+        case 1: return (idx & rowBits) != rowBits ? idx + BLOCK : idx + blockRowTiles_ - rowBits;
+        case 2: return (idx & colBits) != 0 ? idx - 1 : idx - BLOCK_TILES + colBits;
+        default: return (idx & colBits) != colBits ? idx + 1 : idx + BLOCK_TILES - colBits;
+        }
+    }
+
+    // Index dr rows and dc columns (-1, 0 or 1 each) away from idx
+    int step(int idx, int dr, int dc) const {
+        if (dr != 0) idx = neighbor(idx, dr < 0 ? 0 : 1);
+        if (dc != 0) idx = neighbor(idx, dc < 0 ? 2 : 3);
+        return idx;
+    }
+
+private:
+    // Index of (row, col) of the wall-padded grid (border row and column 0)
+    int paddedIndex(int r, int c) const {
+        int block = (r >> BLOCK_BITS) * blockCols_ + (c >> BLOCK_BITS);
+        return (block << (2 * BLOCK_BITS)) | ((r & (BLOCK - 1)) << BLOCK_BITS) | (c & (BLOCK - 1));
+    }
+
+    int stride_;          // Grid row stride, to translate Grid indices
+    int blockCols_;       // blocks per block row
+    int blockRowTiles_;   // tiles in one block row
+    std::pmr::vector<char> tiles_;
+};
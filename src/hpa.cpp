@@ -0,0 +1,321 @@
+/**
+ * Dungeon Pathfinder - Hierarchical Pathfinding
+ *
+ * HPA*: cluster abstraction with precomputed entrance distances.
+ */
+
+#include "hpa.h"
+#include "parallel_bfs.h"
+#include "thread_pool.h"
+#include "bfs_kernel.h"
+#include "solver_stats.h"
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstdlib>
+
+using namespace std;
+
+// Runs of crossings at least this long get an entrance at each end
+static const int ENTRANCE_SPLIT = 6;
+
+namespace {
+
+// One cluster's rectangle as a BfsKernel layout (see grid_layout.h): its
+// tiles copied with a ring of walls around them, so a search cannot leave
+// the cluster. Index (r + 1) * width + c + 1 for cluster-local (r, c).
+class ClusterLayout {
+public:
+    ClusterLayout(const Grid& grid, int row, int col, int rows, int cols)
+        : grid_(grid), row_(row), col_(col), cols_(cols), width_(cols + 2),
+          tiles_(static_cast<size_t>(rows + 2) * width_, '#') {
+        for (int r = 0; r < rows; r++) {
+            const char* src = grid.data() + grid.index(row + r, col);
+            copy(src, src + cols, tiles_.begin() + (r + 1) * width_ + 1);
+        }
+    }
+
+    int size() const { return static_cast<int>(tiles_.size()); }
+    char operator[](int idx) const { return tiles_[idx]; }
+
+    int fromGrid(int gridIdx) const {
+        return (grid_.row(gridIdx) - row_ + 1) * width_ + grid_.col(gridIdx) - col_ + 1;
+    }
+    Cell cellAt(int idx) const { return Cell(row_ + idx / width_ - 1, col_ + idx % width_ - 1); }
+    int step(int idx, int dr, int dc) const { return idx + dr * width_ + dc; }
+
+    // Row-major index inside the rectangle, as HierarchicalMap::localCell
+    int local(int idx) const { return (idx / width_ - 1) * cols_ + idx % width_ - 1; }
+
+private:
+    const Grid& grid_;
+    int row_, col_, cols_, width_;
+    vector<char> tiles_;
+};
+
+} // namespace
+
+
+HierarchicalMap::HierarchicalMap(const Grid& dungeon, const HierarchyOptions& options)
+    : grid_(dungeon), options_(options), size_(max(options.clusterSize, 1)) {
+    clusterRows_ = (grid_.rows() + size_ - 1) / size_;
+    clusterCols_ = (grid_.cols() + size_ - 1) / size_;
+    clusters_.resize(static_cast<size_t>(clusterRows_) * clusterCols_);
+    local_.assign(grid_.size(), -1);
+
+    for (int cr = 0; cr < clusterRows_; cr++) {
+        for (int cc = 0; cc < clusterCols_; cc++) {
+            Cluster& cluster = clusters_[cr * clusterCols_ + cc];
+            cluster.row = cr * size_;
+            cluster.col = cc * size_;
+            cluster.rows = min(size_, grid_.rows() - cluster.row);
+            cluster.cols = min(size_, grid_.cols() - cluster.col);
+        }
+    }
+    // Clusters only write their own cells and tables, so they build in parallel
+    if (grid_.size() >= PARALLEL_MIN_CELLS) {
+        ThreadPool pool(options.threads > 0 ? options.threads : solverThreads());
+        pool.parallelFor(clusters_.size(), 16, [this](size_t begin, size_t end, int) {
+            for (size_t k = begin; k < end; k++) buildCluster(static_cast<int>(k));
+        });
+    } else {
+        for (size_t k = 0; k < clusters_.size(); k++) buildCluster(static_cast<int>(k));
+    }
+    indexNodes();
+    rebuilt_ = clusters_.size();
+    startIdx_ = grid_.find('S');
+    goalIdx_ = grid_.find('E');
+}
+
+// Scans one border of cluster k: length crossings starting at first and
+// advancing by step, each facing the cell across. Both clusters sharing a
+// border scan it in the same order, so they pick the same crossings.
+void HierarchicalMap::addBorder(int k, int first, int step, int length, int across) {
+    Cluster& cluster = clusters_[k];
+    auto add = [&](int idx) {
+        if (local_[idx] != -1) return;  // corner cell already added by another border
+        local_[idx] = static_cast<int>(cluster.nodes.size());
+        cluster.nodes.push_back(idx);
+    };
+
+    for (int t = 0; t < length; ) {
+        int idx = first + t * step;
+        if (blocksWithoutKeys(grid_[idx]) || blocksWithoutKeys(grid_[idx + across])) {
+            t++;
+            continue;
+        }
+        int runStart = t;
+        while (t < length && !blocksWithoutKeys(grid_[first + t * step]) &&
+               !blocksWithoutKeys(grid_[first + t * step + across])) {
+            t++;
+        }
+        int runLength = t - runStart;
+        if (options_.exactEntrances) {
+            for (int i = runStart; i < t; i++) add(first + i * step);
+        } else if (runLength < ENTRANCE_SPLIT) {
+            add(first + (runStart + runLength / 2) * step);
+        } else {
+            add(first + runStart * step);
+            add(first + (t - 1) * step);
+        }
+    }
+}
+
+void HierarchicalMap::buildCluster(int k) {
+    Cluster& cluster = clusters_[k];
+    for (int idx : cluster.nodes) local_[idx] = -1;
+    cluster.nodes.clear();
+
+    const int stride = grid_.stride();
+    const int top = grid_.index(cluster.row, cluster.col);
+    const int bottom = grid_.index(cluster.row + cluster.rows - 1, cluster.col);
+    const int right = top + cluster.cols - 1;
+    if (cluster.row > 0) addBorder(k, top, 1, cluster.cols, -stride);
+    if (cluster.row + cluster.rows < grid_.rows()) addBorder(k, bottom, 1, cluster.cols, stride);
+    if (cluster.col > 0) addBorder(k, top, stride, cluster.rows, -1);
+    if (cluster.col + cluster.cols < grid_.cols()) addBorder(k, right, stride, cluster.rows, 1);
+
+    // One bounded BFS per entrance gives a row of the distance table
+    const size_t n = cluster.nodes.size();
+    cluster.dist.assign(n * n, UNREACHED);
+    vector<uint32_t> dist;
+    for (size_t i = 0; i < n; i++) {
+        clusterBfs(cluster, cluster.nodes[i], dist);
+        for (size_t j = 0; j < n; j++) {
+            cluster.dist[i * n + j] = dist[localCell(cluster, cluster.nodes[j])];
+        }
+    }
+}
+
+// Assigns node ids cluster by cluster
+void HierarchicalMap::indexNodes() {
+    base_.resize(clusters_.size());
+    nodeCell_.clear();
+    for (size_t k = 0; k < clusters_.size(); k++) {
+        base_[k] = static_cast<int>(nodeCell_.size());
+        nodeCell_.insert(nodeCell_.end(), clusters_[k].nodes.begin(), clusters_[k].nodes.end());
+    }
+}
+
+void HierarchicalMap::clusterBfs(const Cluster& cluster, int source, vector<uint32_t>& dist) const {
+    ClusterLayout layout(grid_, cluster.row, cluster.col, cluster.rows, cluster.cols);
+    DoorBlockRule<ClusterLayout> rule(layout);
+    BfsKernel<FourConnected, DoorBlockRule<ClusterLayout>, ClusterLayout, false> bfs(layout, rule);
+    NoStats stats;
+    dist.assign(cluster.rows * cluster.cols, UNREACHED);
+    bfs.run(layout.fromGrid(source), stats, [&](int idx, uint8_t) {
+        dist[layout.local(idx)] = static_cast<uint32_t>(bfs.depth());
+        return false;  // flood the whole cluster
+    });
+}
+
+void HierarchicalMap::refineHop(int from, int to, vector<Cell>& path) const {
+    if (from == to) return;
+    if (clusterOf(from) != clusterOf(to)) {
+        path.push_back(grid_.cellAt(to));  // one move across a border
+        return;
+    }
+    const Cluster& cluster = clusters_[clusterOf(from)];
+    ClusterLayout layout(grid_, cluster.row, cluster.col, cluster.rows, cluster.cols);
+    DoorBlockRule<ClusterLayout> rule(layout);
+    BfsKernel<FourConnected, DoorBlockRule<ClusterLayout>, ClusterLayout> bfs(layout, rule);
+    NoStats stats;
+    const int target = layout.fromGrid(to);
+    int depth = bfs.run(layout.fromGrid(from), stats, [target](int idx, uint8_t) { return idx == target; });
+
+    // Hops come from the cluster's distance table, so to is always reached
+    vector<Cell> hop;
+    bfs.path(depth, hop);
+    path.insert(path.end(), hop.begin() + 1, hop.end());
+}
+
+vector<Cell> HierarchicalMap::findPath(Cell start, Cell goal) const {
+    if (!grid_.inBounds(start.r, start.c) || !grid_.inBounds(goal.r, goal.c)) return {};
+    const int startIdx = grid_.index(start), goalIdx = grid_.index(goal);
+    if (blocksWithoutKeys(grid_[startIdx]) || blocksWithoutKeys(grid_[goalIdx])) return {};
+
+    const int startCluster = clusterOf(startIdx), goalCluster = clusterOf(goalIdx);
+    vector<uint32_t> fromStart, toGoal;
+    clusterBfs(clusters_[startCluster], startIdx, fromStart);
+    clusterBfs(clusters_[goalCluster], goalIdx, toGoal);
+
+    // Abstract graph: every entrance, plus virtual nodes for start and goal
+    const int nodes = static_cast<int>(nodeCell_.size());
+    const int START = nodes, GOAL = nodes + 1;
+    vector<uint32_t> g(nodes + 2, UNREACHED);
+    vector<int> parent(nodes + 2, -1);
+    auto cellOf = [&](int id) { return id == START ? startIdx : id == GOAL ? goalIdx : nodeCell_[id]; };
+    auto heuristic = [&](int id) {
+        int idx = cellOf(id);
+        return static_cast<uint32_t>(abs(grid_.row(idx) - goal.r) + abs(grid_.col(idx) - goal.c));
+    };
+
+    // Queue key: f in the high word, then larger g first. Manhattan
+    // distance is often nearly exact, and without the tie-break A* would
+    // expand every node with f = f(S) before reaching the goal.
+    auto key = [&](int id) {
+        return (static_cast<uint64_t>(g[id] + heuristic(id)) << 32) | (UNREACHED - g[id]);
+    };
+    typedef pair<uint64_t, int> Entry;  // (key, node id)
+    priority_queue<Entry, vector<Entry>, greater<Entry>> open;
+    auto relax = [&](int from, int to, uint32_t cost) {
+        if (cost == UNREACHED) return;
+        uint32_t total = g[from] + cost;
+        if (total >= g[to]) return;
+        g[to] = total;
+        parent[to] = from;
+        open.push({key(to), to});
+    };
+
+    g[START] = 0;
+    open.push({key(START), START});
+    while (!open.empty()) {
+        Entry entry = open.top();
+        open.pop();
+        int u = entry.second;
+        if (entry.first != key(u)) continue;  // stale entry
+        if (u == GOAL) break;
+
+        if (u == START) {
+            const Cluster& cluster = clusters_[startCluster];
+            for (size_t j = 0; j < cluster.nodes.size(); j++) {
+                relax(u, base_[startCluster] + static_cast<int>(j),
+                      fromStart[localCell(cluster, cluster.nodes[j])]);
+            }
+            if (startCluster == goalCluster) relax(u, GOAL, fromStart[localCell(cluster, goalIdx)]);
+            continue;
+        }
+
+        int idx = nodeCell_[u];
+        int k = clusterOf(idx);
+        const Cluster& cluster = clusters_[k];
+        const size_t n = cluster.nodes.size();
+        const uint32_t* row = cluster.dist.data() + local_[idx] * n;
+        for (size_t j = 0; j < n; j++) relax(u, base_[k] + static_cast<int>(j), row[j]);
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int across = idx + grid_.offset(d);
+            if (blocksWithoutKeys(grid_[across]) || local_[across] == -1 || clusterOf(across) == k) continue;
+            relax(u, nodeId(across), 1);
+        }
+        if (k == goalCluster) relax(u, GOAL, toGoal[localCell(cluster, idx)]);
+    }
+    if (g[GOAL] == UNREACHED) return {};
+
+    // Abstract route back to front, then refine hop by hop
+    vector<int> route;
+    for (int id = GOAL; id != -1; id = parent[id]) route.push_back(cellOf(id));
+    reverse(route.begin(), route.end());
+
+    vector<Cell> path;
+    path.reserve(g[GOAL] + 1);
+    path.push_back(start);
+    for (size_t i = 1; i < route.size(); i++) refineHop(route[i - 1], route[i], path);
+    return path;
+}
+
+vector<Cell> HierarchicalMap::findPath() const {
+    if (startIdx_ == -1 || goalIdx_ == -1) return {};
+    return findPath(grid_.cellAt(startIdx_), grid_.cellAt(goalIdx_));
+}
+
+void HierarchicalMap::update(const vector<TileEdit>& edits) {
+    vector<char> dirty(clusters_.size(), 0);
+    vector<int> rebuild;
+    auto mark = [&](int k) {
+        if (!dirty[k]) {
+            dirty[k] = 1;
+            rebuild.push_back(k);
+        }
+    };
+
+    bool endpointsMoved = false;
+    for (const TileEdit& edit : edits) {
+        if (!grid_.inBounds(edit.cell.r, edit.cell.c)) continue;
+        int idx = grid_.index(edit.cell);
+        char before = grid_[idx];
+        if (before == edit.tile) continue;
+        grid_[idx] = edit.tile;
+        endpointsMoved = endpointsMoved || before == 'S' || before == 'E' ||
+                         edit.tile == 'S' || edit.tile == 'E';
+
+        int k = clusterOf(idx);
+        mark(k);
+        // On a border the neighbor's entrances depend on this cell too
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int r = edit.cell.r + DIRECTIONS[d][0], c = edit.cell.c + DIRECTIONS[d][1];
+            if (!grid_.inBounds(r, c)) continue;
+            int other = clusterOf(grid_.index(r, c));
+            if (other != k) mark(other);
+        }
+    }
+
+    for (int k : rebuild) buildCluster(k);
+    indexNodes();
+    rebuilt_ = rebuild.size();
+    if (endpointsMoved) {
+        startIdx_ = grid_.find('S');
+        goalIdx_ = grid_.find('E');
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "incremental.h"
+
+/**
+ * Preprocessing knobs for HierarchicalMap.
+ */
+struct HierarchyOptions {
+    int clusterSize = 16;         // side of the square clusters, in cells
+    bool exactEntrances = false;  // keep every border crossing: exact but larger graph
+    int threads = 0;              // build threads for large maps (0 = solverThreads())
+};
+
+/**
+ * Hierarchical pathfinding (HPA*) for repeated queries on a large map.
+ *
+ * Preprocessing tiles the dungeon into square clusters. Wherever open cells
+ * face each other across a cluster border, entrance cells are placed: one
+ * in the middle of each run of crossings, or one at each end of a long
+ * run. A BFS bounded to each cluster then stores the distance between
+ * every pair of its entrances. Together these form the abstract graph:
+ * intra-cluster edges weighted by those distances, and one-move edges
+ * between facing entrances.
+ *
+ * A query BFSes S and E into their own clusters and runs A* (Manhattan
+ * heuristic) over the abstract graph. Only the hops of the winning route
+ * are then refined into cells, each with a BFS bounded to one cluster.
+ *
+ * Paths are always valid. With compressed entrances they can be slightly
+ * longer than bfsPath's, since the route must cross at an entrance. With
+ * exactEntrances every crossing is an entrance, and the length is exactly
+ * bfsPath's. Doors block, as in bfsPath.
+ *
+ * Best on maps with open rooms. In a perfect maze nearly every crossing is
+ * its own run, so the abstract graph stays large, and Manhattan distance
+ * guides A* poorly; queries there cost about as much as a full BFS.
+ */
+class HierarchicalMap {
+public:
+    /**
+     * Builds the cluster abstraction.
+     *
+     * @param dungeon The dungeon (copied)
+     * @param options Cluster size and entrance policy
+     */
+    explicit HierarchicalMap(const Grid& dungeon, const HierarchyOptions& options = HierarchyOptions());
+
+    /**
+     * @param start Source cell
+     * @param goal Target cell
+     * @return Path from start to goal, or empty vector if unreachable
+     */
+    std::vector<Cell> findPath(Cell start, Cell goal) const;
+
+    // Path from S to E, or empty vector if either is missing or unreachable
+    std::vector<Cell> findPath() const;
+
+    /**
+     * Applies tile edits and rebuilds only the clusters they touch: the
+     * edited cell's cluster, plus a neighbor when the cell lies on their
+     * shared border (its entrances may move).
+     *
+     * @param edits Tile changes (off-map cells are ignored)
+     */
+    void update(const std::vector<TileEdit>& edits);
+
+    const Grid& dungeon() const { return grid_; }
+    size_t clusterCount() const { return clusters_.size(); }
+    size_t nodeCount() const { return nodeCell_.size(); }
+
+    // Clusters rebuilt by the last update (all of them after construction)
+    size_t lastRebuilt() const { return rebuilt_; }
+
+private:
+    struct Cluster {
+        int row, col, rows, cols;     // covered rectangle
+        std::vector<int> nodes;       // entrance cells (grid buffer indices)
+        std::vector<uint32_t> dist;   // nodes x nodes intra-cluster distances
+    };
+
+    static constexpr uint32_t UNREACHED = 0xFFFFFFFFu;
+
+    int clusterOf(int idx) const {
+        return (grid_.row(idx) / size_) * clusterCols_ + grid_.col(idx) / size_;
+    }
+    int nodeId(int idx) const { return base_[clusterOf(idx)] + local_[idx]; }
+
+    void buildCluster(int k);
+    void addBorder(int k, int first, int step, int length, int across);
+    void indexNodes();
+
+    /**
+     * BFS from source confined to one cluster (BfsKernel with bfsPath's
+     * DoorBlockRule, see bfs_kernel.h).
+     *
+     * @param dist Distances per cluster-local cell (row-major in the rectangle)
+     */
+    void clusterBfs(const Cluster& cluster, int source, std::vector<uint32_t>& dist) const;
+    int localCell(const Cluster& cluster, int idx) const {
+        return (grid_.row(idx) - cluster.row) * cluster.cols + (grid_.col(idx) - cluster.col);
+    }
+
+    // Appends the cells after from up to and including to, inside one cluster
+    void refineHop(int from, int to, std::vector<Cell>& path) const;
+
+    Grid grid_;
+    HierarchyOptions options_;
+    int size_;
+    int clusterRows_, clusterCols_;
+    std::vector<Cluster> clusters_;
+    std::vector<int> local_;      // per grid cell: index in its cluster's nodes, or -1
+    std::vector<int> base_;       // per cluster: id of its first node
+    std::vector<int> nodeCell_;   // per node id: grid cell
+    int startIdx_ = -1, goalIdx_ = -1;
+    size_t rebuilt_ = 0;
+};
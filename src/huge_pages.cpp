@@ -0,0 +1,50 @@
+#include "huge_pages.h"
+#include <cstdint>
+#include <new>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+// Bytes actually mapped for a request: whole huge pages
+static size_t mappedBytes(size_t bytes) {
+    return (bytes + HugePageResource::HUGE_PAGE_BYTES - 1) & ~(HugePageResource::HUGE_PAGE_BYTES - 1);
+}
+
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment) {
+#ifndef _WIN32
+    if (bytes >= HUGE_PAGE_BYTES && alignment <= HUGE_PAGE_BYTES) {
+        // Over-map by one huge page, then trim both ends to an aligned run
+        size_t length = mappedBytes(bytes);
+        void* mapping = mmap(nullptr, length + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) throw bad_alloc();
+        uintptr_t begin = reinterpret_cast<uintptr_t>(mapping);
+        uintptr_t aligned = (begin + HUGE_PAGE_BYTES - 1) & ~uintptr_t(HUGE_PAGE_BYTES - 1);
+        if (aligned > begin) munmap(mapping, aligned - begin);
+        size_t tail = HUGE_PAGE_BYTES - (aligned - begin);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + length), tail);
+#ifdef MADV_HUGEPAGE
+        madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+#endif
+        return reinterpret_cast<void*>(aligned);
+    }
+#endif
+    return upstream_->allocate(bytes, alignment);
+}
+
+void HugePageResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+#ifndef _WIN32
+    if (bytes >= HUGE_PAGE_BYTES && alignment <= HUGE_PAGE_BYTES) {
+        munmap(pointer, mappedBytes(bytes));
+        return;
+    }
+#endif
+    upstream_->deallocate(pointer, bytes, alignment);
+}
+
+pmr::memory_resource* hugePageResource() {
+    static HugePageResource resource;
+    return &resource;
+}
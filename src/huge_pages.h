@@ -0,0 +1,39 @@
+#pragma once
+#include <memory_resource>
+#include <cstddef>
+
+/**
+ * Memory resource that backs large buffers with 2 MiB huge pages, so one
+ * TLB entry covers 512 ordinary pages of an 8k x 8k grid or its visited
+ * and parent arrays. Each request of at least HUGE_PAGE_BYTES is mapped
+ * on its own, aligned to a huge page and marked with
+ * madvise(MADV_HUGEPAGE); the kernel's transparent huge pages must be in
+ * "madvise" or "always" mode for that to take effect. Smaller requests,
+ * and every request where mmap is not available, go to upstream.
+ *
+ * Pass it wherever a memory resource is taken, e.g. the arena overloads of
+ * bfsPath and generateDungeonGrid.
+ */
+class HugePageResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t HUGE_PAGE_BYTES = size_t(2) << 20;
+
+    explicit HugePageResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream_(upstream) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+};
+
+/**
+ * Process-wide HugePageResource over the default resource.
+ *
+ * @return Shared huge-page resource (never null)
+ */
+std::pmr::memory_resource* hugePageResource();
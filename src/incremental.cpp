@@ -0,0 +1,267 @@
+/**
+ * Dungeon Pathfinder - Incremental Solver
+ *
+ * Dynamic BFS: repairs only the distances a batch of tile edits changes.
+ */
+
+#include "incremental.h"
+#include "tiles.h"
+#include <vector>
+#include <string>
+#include <queue>
+#include <functional>
+#include <utility>
+
+using namespace std;
+
+typedef pair<uint32_t, uint64_t> Entry;  // (distance, state)
+typedef priority_queue<Entry, vector<Entry>, greater<Entry>> MinQueue;
+
+IncrementalSolver::IncrementalSolver(const Grid& dungeon, SolveRules rules)
+    : grid_(dungeon), rules_(rules) {
+    rebuild();
+}
+
+IncrementalSolver::IncrementalSolver(const vector<string>& dungeon, SolveRules rules)
+    : grid_(Grid::fromStrings(dungeon)), rules_(rules) {
+    rebuild();
+}
+
+// Builds the character -> tile class table. Keys are numbered as a TileMap
+// numbers them, so key layers match bfsPathKeys.
+void IncrementalSolver::classifyTiles() {
+    for (int ch = 0; ch < 256; ch++) classOf_[ch] = TILE_FLOOR;
+    classOf_[static_cast<unsigned char>('#')] = TILE_WALL;
+
+    if (rules_ == SolveRules::Basic) {
+        // Doors never open
+        for (char ch = 'A'; ch <= 'Z'; ch++) {
+            if (isDoorTile(ch)) classOf_[static_cast<unsigned char>(ch)] = TILE_WALL;
+        }
+        layers_ = 1;
+        return;
+    }
+
+    TileMap tiles(grid_, DEFAULT_NUM_KEYS);
+    for (int ch = 'A'; ch < 'A' + DEFAULT_NUM_KEYS; ch++) {
+        if (ch != 'E' && ch != 'S') classOf_[ch] = TILE_WALL;  // door without a key
+    }
+    for (int bit = 0; bit < tiles.numKeys(); bit++) {
+        char key = tiles.keyLetter(bit);
+        classOf_[static_cast<unsigned char>(key)] = static_cast<uint8_t>(TILE_KEY | bit);
+        char door = static_cast<char>(key - 'a' + 'A');
+        if (door != 'E' && door != 'S') {
+            classOf_[static_cast<unsigned char>(door)] = static_cast<uint8_t>(TILE_DOOR | bit);
+        }
+    }
+    layers_ = tiles.numLayers();
+}
+
+// Whether a state in key layer keys may stand on a tile of this class
+bool IncrementalSolver::open(uint64_t keys, uint8_t tile) const {
+    if (tile == TILE_WALL) return false;
+    if (tile & TILE_DOOR) return (keys >> (tile & TILE_BIT_MASK)) & 1;
+    return true;
+}
+
+void IncrementalSolver::rebuild() {
+    classifyTiles();
+    cells_ = static_cast<uint64_t>(grid_.size());
+    dist_.assign(cells_ * layers_, UNREACHED);
+    startIdx_ = grid_.find('S');
+    repaired_ = dist_.size();
+    if (startIdx_ == -1) return;
+
+    // Plain BFS over the state graph from S
+    vector<uint64_t> q{static_cast<uint64_t>(startIdx_)};
+    dist_[startIdx_] = 0;
+    for (size_t head = 0; head < q.size(); head++) {
+        uint64_t state = q[head];
+        uint64_t keys = state / cells_;
+        int idx = static_cast<int>(state % cells_);
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int n = idx + grid_.offset(d);
+            uint8_t tile = tileAt(n);
+            if (!open(keys, tile)) continue;
+            uint64_t nextKeys = (tile & TILE_KEY) ? keys | (uint64_t(1) << (tile & TILE_BIT_MASK)) : keys;
+            uint64_t next = nextKeys * cells_ + n;
+            if (dist_[next] != UNREACHED) continue;
+            dist_[next] = dist_[state] + 1;
+            q.push_back(next);
+        }
+    }
+}
+
+// Calls fn(predecessor) for every state with an edge into state. Entering a
+// key cell may have picked its key up, so predecessors can also sit in the
+// layer without that key.
+template <typename Fn>
+static void forEachPredecessor(uint64_t state, uint64_t cells, const Grid& grid, uint8_t tile, Fn fn) {
+    uint64_t keys = state / cells;
+    int idx = static_cast<int>(state % cells);
+    uint64_t layers[2] = {keys, keys};
+    int count = 1;
+    if (tile & TILE_KEY) {
+        uint64_t bit = uint64_t(1) << (tile & TILE_BIT_MASK);
+        if (keys & bit) layers[count++] = keys & ~bit;
+    }
+    for (int d = 0; d < NUM_DIRECTIONS; d++) {
+        int prev = idx - grid.offset(d);
+        for (int i = 0; i < count; i++) fn(layers[i] * cells + prev);
+    }
+}
+
+// Calls fn(successor) for every state reachable in one move from state
+template <typename Fn>
+static void forEachSuccessor(uint64_t state, uint64_t cells, const Grid& grid,
+                             const uint8_t* classOf, Fn fn) {
+    uint64_t keys = state / cells;
+    int idx = static_cast<int>(state % cells);
+    for (int d = 0; d < NUM_DIRECTIONS; d++) {
+        int n = idx + grid.offset(d);
+        uint8_t tile = classOf[static_cast<unsigned char>(grid[n])];
+        if (tile == TILE_WALL) continue;
+        if ((tile & TILE_DOOR) && !((keys >> (tile & TILE_BIT_MASK)) & 1)) continue;
+        uint64_t nextKeys = (tile & TILE_KEY) ? keys | (uint64_t(1) << (tile & TILE_BIT_MASK)) : keys;
+        fn(nextKeys * cells + n);
+    }
+}
+
+bool IncrementalSolver::hasCloserPredecessor(uint64_t state) const {
+    uint32_t want = dist_[state] - 1;
+    bool found = false;
+    forEachPredecessor(state, cells_, grid_, tileAt(static_cast<int>(state % cells_)),
+                       [&](uint64_t prev) { found = found || dist_[prev] == want; });
+    return found;
+}
+
+uint32_t IncrementalSolver::bestPredecessor(uint64_t state) const {
+    uint32_t best = UNREACHED;
+    forEachPredecessor(state, cells_, grid_, tileAt(static_cast<int>(state % cells_)),
+                       [&](uint64_t prev) { best = min(best, dist_[prev]); });
+    return best;
+}
+
+vector<Cell> IncrementalSolver::update(const vector<TileEdit>& edits) {
+    // Apply the edits, collecting cells whose class changed. Anything that
+    // changes the key set or S alters the state space: rebuild instead.
+    vector<pair<int, uint8_t>> changed;  // (cell, class before)
+    bool needRebuild = false;
+    for (const TileEdit& edit : edits) {
+        if (!grid_.inBounds(edit.cell.r, edit.cell.c)) continue;
+        int idx = grid_.index(edit.cell);
+        char before = grid_[idx];
+        if (before == edit.tile) continue;
+        uint8_t oldClass = tileAt(idx);
+        grid_[idx] = edit.tile;
+
+        bool key = rules_ == SolveRules::Keys &&
+                   ((before >= 'a' && before < 'a' + DEFAULT_NUM_KEYS) ||
+                    (edit.tile >= 'a' && edit.tile < 'a' + DEFAULT_NUM_KEYS));
+        if (key || before == 'S' || edit.tile == 'S') needRebuild = true;
+        if (oldClass != tileAt(idx)) changed.emplace_back(idx, oldClass);
+    }
+    if (needRebuild) {
+        rebuild();
+        return path();
+    }
+
+    // Phase 1: states that became blocked lose their distance, then any
+    // successor left without a predecessor one move closer follows, in
+    // order of old distance (so closer states are always final first)
+    vector<uint64_t> invalidated;
+    vector<uint64_t> opened;
+    MinQueue check;
+    for (const pair<int, uint8_t>& change : changed) {
+        uint8_t now = tileAt(change.first);
+        for (uint64_t keys = 0; keys < layers_; keys++) {
+            uint64_t state = keys * cells_ + change.first;
+            bool wasOpen = open(keys, change.second), isOpen = open(keys, now);
+            if (isOpen && !wasOpen) opened.push_back(state);
+            if (wasOpen && !isOpen && dist_[state] != UNREACHED) {
+                uint32_t old = dist_[state];
+                dist_[state] = UNREACHED;
+                // The blocked cell can no longer feed its old successors
+                forEachSuccessor(state, cells_, grid_, classOf_, [&](uint64_t next) {
+                    if (dist_[next] == old + 1) check.push({old + 1, next});
+                });
+            }
+        }
+    }
+    while (!check.empty()) {
+        Entry entry = check.top();
+        check.pop();
+        uint64_t state = entry.second;
+        if (dist_[state] != entry.first || hasCloserPredecessor(state)) continue;
+        dist_[state] = UNREACHED;
+        invalidated.push_back(state);
+        forEachSuccessor(state, cells_, grid_, classOf_, [&](uint64_t next) {
+            if (dist_[next] == entry.first + 1) check.push({entry.first + 1, next});
+        });
+    }
+
+    // Phase 2: tentative distances from intact neighbors, then Dijkstra
+    // (unit weights) over everything that can improve
+    MinQueue settle;
+    auto seed = [&](uint64_t state) {
+        uint32_t best = bestPredecessor(state);
+        if (best == UNREACHED || best + 1 >= dist_[state]) return;
+        dist_[state] = best + 1;
+        settle.push({best + 1, state});
+    };
+    for (uint64_t state : invalidated) seed(state);
+    for (uint64_t state : opened) seed(state);
+
+    repaired_ = invalidated.size() + opened.size();
+    while (!settle.empty()) {
+        Entry entry = settle.top();
+        settle.pop();
+        if (dist_[entry.second] != entry.first) continue;  // stale entry
+        forEachSuccessor(entry.second, cells_, grid_, classOf_, [&](uint64_t next) {
+            if (dist_[next] <= entry.first + 1) return;
+            dist_[next] = entry.first + 1;
+            settle.push({entry.first + 1, next});
+            repaired_++;
+        });
+    }
+    return path();
+}
+
+// Best goal state over the key layers; returns its distance or -1
+int IncrementalSolver::goalState(uint64_t& state) const {
+    int goalIdx = grid_.find('E');
+    if (goalIdx == -1 || startIdx_ == -1) return -1;
+    uint32_t best = UNREACHED;
+    for (uint64_t keys = 0; keys < layers_; keys++) {
+        uint64_t s = keys * cells_ + goalIdx;
+        if (dist_[s] < best) {
+            best = dist_[s];
+            state = s;
+        }
+    }
+    return best == UNREACHED ? -1 : static_cast<int>(best);
+}
+
+int IncrementalSolver::distance() const {
+    uint64_t state = 0;
+    return goalState(state);
+}
+
+vector<Cell> IncrementalSolver::path() const {
+    uint64_t state = 0;
+    int length = goalState(state);
+    if (length < 0) return {};
+
+    // Walk back through predecessors one move closer, filling back to front
+    vector<Cell> result(length + 1);
+    for (int step = length; step > 0; step--) {
+        result[step] = grid_.cellAt(static_cast<int>(state % cells_));
+        uint32_t want = static_cast<uint32_t>(step - 1);
+        uint64_t next = state;
+        forEachPredecessor(state, cells_, grid_, tileAt(static_cast<int>(state % cells_)),
+                           [&](uint64_t prev) { if (next == state && dist_[prev] == want) next = prev; });
+        state = next;
+    }
+    result[0] = grid_.cellAt(startIdx_);
+    return result;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "solver.h"
+
+/**
+ * One tile change applied to a live dungeon.
+ */
+struct TileEdit {
+    Cell cell;  // position to change
+    char tile;  // new character ('#', ' ', a door, ...)
+};
+
+/**
+ * Shortest path from S to E that is kept up to date as tiles change.
+ *
+ * The solver keeps the BFS distance of every state (cell, or key layer and
+ * cell for SolveRules::Keys) from S. After a batch of edits only the
+ * distances that actually change are repaired, dynamic-BFS style:
+ *
+ *  1. States that became blocked lose their distance; every successor is
+ *     then checked in order of its old distance, and loses its distance too
+ *     if no predecessor one move closer survives.
+ *  2. The invalidated states and the newly opened ones get a tentative
+ *     distance from their intact neighbors and are settled with a
+ *     Dijkstra pass, which also spreads any shortcut an opening creates.
+ *
+ * Edits that add or remove a key, or move S, change the state space itself
+ * and fall back to a full rebuild. Results always equal a fresh bfsPath /
+ * bfsPathKeys (same length; a valid path).
+ */
+class IncrementalSolver {
+public:
+    /**
+     * @param dungeon Initial dungeon (copied)
+     * @param rules Movement rules: bfsPath's or bfsPathKeys'
+     */
+    explicit IncrementalSolver(const Grid& dungeon, SolveRules rules = SolveRules::Basic);
+    explicit IncrementalSolver(const std::vector<std::string>& dungeon,
+                               SolveRules rules = SolveRules::Basic);
+
+    /**
+     * Applies edits (off-map cells are ignored), repairs the distances and
+     * returns the new shortest path.
+     *
+     * @param edits Tile changes, applied in order
+     * @return Path from S to E, or empty vector if no path exists
+     */
+    std::vector<Cell> update(const std::vector<TileEdit>& edits);
+
+    // Current shortest path, or empty vector if E is unreachable
+    std::vector<Cell> path() const;
+
+    // Current number of moves from S to E, or -1 if unreachable
+    int distance() const;
+
+    const Grid& dungeon() const { return grid_; }
+
+    // States whose distance the last update recomputed (all of them after a rebuild)
+    size_t lastRepaired() const { return repaired_; }
+
+private:
+    static constexpr uint32_t UNREACHED = 0xFFFFFFFFu;
+
+    void rebuild();
+    void classifyTiles();
+    uint8_t tileAt(int idx) const { return classOf_[static_cast<unsigned char>(grid_[idx])]; }
+    bool open(uint64_t keys, uint8_t tile) const;
+    bool hasCloserPredecessor(uint64_t state) const;
+    uint32_t bestPredecessor(uint64_t state) const;
+    int goalState(uint64_t& state) const;
+
+    Grid grid_;
+    SolveRules rules_;
+    int startIdx_ = -1;
+    uint64_t cells_ = 0, layers_ = 1;
+    uint8_t classOf_[256];         // tile class (see tiles.h) of each character
+    std::vector<uint32_t> dist_;   // per state: keys * cells + cell index
+    size_t repaired_ = 0;
+};
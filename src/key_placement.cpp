@@ -0,0 +1,206 @@
+#include "key_placement.h"
+#include "rng.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+using namespace std;
+
+// Marks the cells reachable from start without entering walls or closed cells
+static void floodFrom(const Grid& dungeon, int start, const vector<uint8_t>& closed, vector<uint8_t>& reached) {
+    reached.assign(dungeon.size(), 0);
+    vector<int> queue{start};
+    reached[start] = 1;
+    for (size_t head = 0; head < queue.size(); head++) {
+        int idx = queue[head];
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int neighbor = idx + dungeon.offset(d);
+            if (dungeon[neighbor] != '#' && !closed[neighbor] && !reached[neighbor]) {
+                reached[neighbor] = 1;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+}
+
+// A cell on every route from S to E, and how many open cells other than S
+// lie on S's side of it
+struct CutCell {
+    int cell, before;
+};
+
+// Cells other than start and goal that lie on every route between them, in
+// route order from start. Iterative Tarjan DFS from start: a vertex v on
+// the tree path to goal separates them when the path child w below it has
+// no back edge above v (low[w] >= disc[v]). Shutting v cuts off w's subtree
+// and every other child subtree of v with no back edge above v (dead ends
+// hanging off v); the rest stays on start's side.
+static vector<CutCell> cutCells(const Grid& dungeon, int start, int goal) {
+    vector<int> disc(dungeon.size(), -1), low(dungeon.size()), parent(dungeon.size(), -1);
+    vector<int> subtree(dungeon.size(), 1), severed(dungeon.size(), 0);
+    vector<uint8_t> tried(dungeon.size(), 0);
+    vector<int> stack{start};
+    int time = 0;
+    disc[start] = low[start] = time++;
+
+    while (!stack.empty()) {
+        int v = stack.back();
+        if (tried[v] < NUM_DIRECTIONS) {
+            int w = v + dungeon.offset(tried[v]++);
+            if (dungeon[w] == '#') continue;
+            if (disc[w] < 0) {
+                parent[w] = v;
+                disc[w] = low[w] = time++;
+                stack.push_back(w);
+            } else if (w != parent[v]) {
+                low[v] = min(low[v], disc[w]);
+            }
+            continue;
+        }
+        stack.pop_back();
+        if (parent[v] >= 0) {
+            low[parent[v]] = min(low[parent[v]], low[v]);
+            subtree[parent[v]] += subtree[v];
+            if (low[v] >= disc[parent[v]]) severed[parent[v]] += subtree[v];
+        }
+    }
+
+    vector<CutCell> cuts;
+    if (disc[goal] < 0) return cuts;
+    for (int w = goal, v = parent[goal]; v != start; w = v, v = parent[v]) {
+        if (low[w] >= disc[v]) cuts.push_back({v, subtree[start] - severed[v] - 2});
+    }
+    reverse(cuts.begin(), cuts.end());
+    return cuts;
+}
+
+// A random free floor cell of region, preferring cells outside avoid
+// (nullptr: no preference); -1 if region has none
+static int pickCell(const Grid& dungeon, const vector<uint8_t>& region, const vector<uint8_t>* avoid,
+                    const vector<uint8_t>& used, Xoshiro256& rng) {
+    vector<int> preferred, fallback;
+    for (int idx = 0; idx < dungeon.size(); idx++) {
+        if (!region[idx] || dungeon[idx] != ' ' || used[idx]) continue;
+        (avoid && (*avoid)[idx] ? fallback : preferred).push_back(idx);
+    }
+    const vector<int>& cells = preferred.empty() ? fallback : preferred;
+    if (cells.empty()) return -1;
+    return cells[randomBelow(rng, static_cast<uint32_t>(cells.size()))];
+}
+
+KeyPlacement placeKeysAndDoors(Grid& dungeon, int pairs, int required, uint64_t seed) {
+    KeyPlacement placed;
+    int start = dungeon.find('S'), goal = dungeon.find('E');
+    pairs = min(pairs, MAX_PLACED_KEYS);
+    if (start < 0 || goal < 0 || pairs <= 0) return placed;
+
+    Xoshiro256 rng(seed);
+    if (required < 0) required = static_cast<int>(randomBelow(rng, pairs + 1));
+    required = min(required, pairs);
+
+    // Required doors: a random subset of the cut cells, kept in route order
+    // (selection sampling). Only cuts with room for every door and key on
+    // S's side qualify, so no key can run out of cells.
+    vector<uint8_t> isCut(dungeon.size(), 0);
+    vector<int> cuts;
+    for (const CutCell& cut : cutCells(dungeon, start, goal)) {
+        isCut[cut.cell] = 1;
+        if (cut.before >= 2 * pairs) cuts.push_back(cut.cell);
+    }
+    vector<int> doors;
+    size_t needed = min<size_t>(required, cuts.size());
+    for (size_t i = 0; i < cuts.size() && needed > 0; i++) {
+        if (randomBelow(rng, static_cast<uint32_t>(cuts.size() - i)) < needed) {
+            doors.push_back(cuts[i]);
+            needed--;
+        }
+    }
+
+    // Optional doors: floor cells off the cut, skipping any that would cut S
+    // from E together with the optional doors already chosen
+    vector<int> floor, optional;
+    for (int idx = 0; idx < dungeon.size(); idx++) {
+        if (dungeon[idx] == ' ' && !isCut[idx]) floor.push_back(idx);
+    }
+    vector<uint8_t> shut(dungeon.size(), 0), reached;
+    for (int attempts = 0; optional.size() + doors.size() < static_cast<size_t>(pairs) && !floor.empty() &&
+                           attempts < 8 * MAX_PLACED_KEYS; attempts++) {
+        uint32_t pick = randomBelow(rng, static_cast<uint32_t>(floor.size()));
+        int idx = floor[pick];
+        floor[pick] = floor.back();
+        floor.pop_back();
+        shut[idx] = 1;
+        floodFrom(dungeon, start, shut, reached);
+        if (reached[goal]) {
+            optional.push_back(idx);
+        } else {
+            shut[idx] = 0;
+        }
+    }
+
+    vector<uint8_t> used(dungeon.size(), 0);
+    for (int idx : doors) used[idx] = 1;
+    for (int idx : optional) used[idx] = 1;
+
+    // Optional keys: reachable with every door shut
+    vector<uint8_t> closed = shut;
+    for (int idx : doors) closed[idx] = 1;
+    floodFrom(dungeon, start, closed, reached);
+    vector<int> optionalKeys;
+    for (size_t i = 0; i < optional.size(); i++) {
+        int key = pickCell(dungeon, reached, nullptr, used, rng);
+        if (key < 0) {
+            used[optional[i]] = shut[optional[i]] = 0;  // no room for its key: drop the pair
+            optional.erase(optional.begin() + i--);
+            continue;
+        }
+        used[key] = 1;
+        optionalKeys.push_back(key);
+    }
+
+    // Required key j: reachable with doors j and later and every optional
+    // door shut, so no optional key is ever needed, preferably past door
+    // j - 1. Door j has at least 2 * pairs open cells before it, so a cell
+    // is free unless optional doors wall them off; then door j is dropped.
+    vector<int> requiredKeys;
+    vector<uint8_t> previous;
+    for (size_t j = 0; j < doors.size(); j++) {
+        closed = shut;
+        for (size_t k = j; k < doors.size(); k++) closed[doors[k]] = 1;
+        floodFrom(dungeon, start, closed, reached);
+        int key = pickCell(dungeon, reached, j > 0 ? &previous : nullptr, used, rng);
+        if (key < 0) {
+            assert(!optional.empty() && "a required door always has free cells before it");
+            used[doors[j]] = 0;
+            doors.erase(doors.begin() + j--);
+            continue;
+        }
+        used[key] = 1;
+        requiredKeys.push_back(key);
+        previous = reached;
+    }
+
+    // Letters are shuffled so they do not reveal which doors are required
+    char letters[MAX_PLACED_KEYS];
+    copy(PLACEABLE_KEYS, PLACEABLE_KEYS + MAX_PLACED_KEYS, letters);
+    shuffle(letters, letters + MAX_PLACED_KEYS, rng);
+    int pair = 0;
+    for (size_t j = 0; j < doors.size(); j++, pair++) {
+        dungeon[doors[j]] = static_cast<char>(letters[pair] - 'a' + 'A');
+        dungeon[requiredKeys[j]] = letters[pair];
+    }
+    for (size_t i = 0; i < optional.size(); i++, pair++) {
+        dungeon[optional[i]] = static_cast<char>(letters[pair] - 'a' + 'A');
+        dungeon[optionalKeys[i]] = letters[pair];
+    }
+    placed.pairs = pair;
+    placed.required = static_cast<int>(doors.size());
+    placed.keyCells = requiredKeys;
+    placed.keyCells.insert(placed.keyCells.end(), optionalKeys.begin(), optionalKeys.end());
+    placed.doorCells = doors;
+    placed.doorCells.insert(placed.doorCells.end(), optional.begin(), optional.end());
+    sort(placed.keyCells.begin(), placed.keyCells.end());
+    sort(placed.doorCells.begin(), placed.doorCells.end());
+    return placed;
+}
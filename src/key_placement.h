@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "grid.h"
+
+// Key letters the generator places, each with its door: 'e' is left out
+// because door 'E' would be the exit
+const char PLACEABLE_KEYS[] = "abcdf";
+const int MAX_PLACED_KEYS = 5;
+
+/**
+ * What placeKeysAndDoors actually placed.
+ */
+struct KeyPlacement {
+    int pairs = 0;      // key/door pairs in the dungeon
+    int required = 0;   // of those, doors that every route from S to E crosses
+    std::vector<int> keyCells, doorCells;  // buffer indices of the keys and doors, ascending
+};
+
+/**
+ * Places matching keys and doors into a dungeon of walls, floor, S and E,
+ * keeping it solvable for bfsPathKeys with exactly `required` keys that
+ * must be picked up.
+ *
+ * Required doors go on cut cells: cells every S-to-E route passes through,
+ * found with one iterative Tarjan DFS. In a perfect maze that is the whole
+ * S-to-E path; rooms add detours and leave fewer. Optional doors go on
+ * other floor cells, only where S can still reach E with every optional
+ * door shut, and their keys are reachable from S with every door shut.
+ * Key j of the required doors (in route order) is put on a random floor
+ * cell reachable with the earlier required doors open and every optional
+ * door shut, preferring cells past door j - 1 so the route has to visit
+ * each stretch; a required door with no such cell left is not placed.
+ *
+ * @param dungeon Dungeon to modify in place
+ * @param pairs Key/door pairs wanted (at most MAX_PLACED_KEYS)
+ * @param required Pairs that must be picked up, or -1 to draw 0..pairs from seed
+ * @param seed Seed for every placement choice
+ * @return Pairs and required doors placed (fewer on small or very open maps)
+ */
+KeyPlacement placeKeysAndDoors(Grid& dungeon, int pairs, int required, uint64_t seed);
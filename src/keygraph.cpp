@@ -0,0 +1,269 @@
+/**
+ * Dungeon Pathfinder - Key-Graph Solver
+ *
+ * Compresses the key-door search to a graph over points of interest
+ * (start, exit, keys) and runs Dijkstra over (point, key set) pairs.
+ */
+
+#include "keygraph.h"
+#include "solver.h"
+#include "dense.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <climits>
+
+using namespace std;
+
+// Below this many open cells layered BFS is already fast, and keeping it
+// lets the small test dungeons exercise it
+static const int MIN_KEY_GRAPH_CELLS = 4096;
+
+// The key graph must expect to touch this many times fewer cells than
+// layered BFS before it is chosen
+static const uint64_t KEY_GRAPH_MARGIN = 4;
+
+bool keyGraphIsCheaper(const TileMap& tiles) {
+    int k = tiles.numKeys();
+    if (tiles.openCells() < MIN_KEY_GRAPH_CELLS || k < 2) return false;
+    // Layered BFS: ~open * 2^k states. Key graph: up to a map of cells per
+    // leg search, and about one search per point (S, E and every key tile)
+    // when each letter appears once; many tiles of a letter multiply both
+    // the points and the key sets each one is searched with.
+    uint64_t points = static_cast<uint64_t>(tiles.keyTiles()) + 2;
+    return KEY_GRAPH_MARGIN * points <= tiles.numLayers();
+}
+
+// Slots a hashed Dijkstra table starts with
+static const size_t MIN_HASHED_LABELS = 1024;
+
+static size_t labelHash(uint64_t state) {
+    uint64_t h = state * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+KeyGraphSolver::Label& KeyGraphSolver::label(uint64_t state) {
+    size_t slot;
+    if (directLabels_) {
+        slot = static_cast<size_t>((state >> 32) * points_.size() + (state & 0xFFFFFFFF));
+    } else {
+        // Linear probing, kept at most half full
+        if (2 * (labelCount_ + 1) > labels_.size()) growLabels();
+        const size_t mask = labels_.size() - 1;
+        slot = labelHash(state) & mask;
+        while (labels_[slot].stamp == solveStamp_ && labels_[slot].state != state) slot = (slot + 1) & mask;
+    }
+    Label& found = labels_[slot];
+    if (found.stamp != solveStamp_) {
+        found = Label{state, 0, INT_MAX, solveStamp_};
+        labelCount_++;
+    }
+    return found;
+}
+
+void KeyGraphSolver::growLabels() {
+    vector<Label> old(labels_.size() * 2);
+    old.swap(labels_);
+    const size_t mask = labels_.size() - 1;
+    for (const Label& moved : old) {
+        if (moved.stamp != solveStamp_) continue;
+        size_t slot = labelHash(moved.state) & mask;
+        while (labels_[slot].stamp == solveStamp_) slot = (slot + 1) & mask;
+        labels_[slot] = moved;
+    }
+}
+
+int KeyGraphSolver::pointAt(int idx) const {
+    auto it = lower_bound(sorted_.begin(), sorted_.end(), make_pair(idx, 0));
+    return it->second;
+}
+
+// Grid BFS between points of interest with a fixed key set. Doors whose key
+// is held are open; keys not yet held and the exit end a leg (they are
+// targets, not expanded), since picking up a key changes the key set.
+void KeyGraphSolver::search(int fromIdx, uint32_t keys, int stopIdx, Leg* leg) {
+    const Grid& dungeon = *dungeon_;
+    const TileMap& tiles = *tiles_;
+    // Generation stamps avoid clearing visited between searches, and
+    // between dungeons: stamps of an earlier map are all older
+    if (++generation_ == 0) {
+        fill(stamp_.begin(), stamp_.end(), 0);
+        generation_ = 1;
+    }
+    frontier_.assign(1, fromIdx);
+    stamp_[fromIdx] = generation_;
+
+    for (int dist = 1; !frontier_.empty(); dist++) {
+        next_.clear();
+        for (int cur : frontier_) {
+            for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                int n = cur + dungeon.offset(d);
+                uint8_t tile = tiles[n];
+                if (tile == TILE_WALL || stamp_[n] == generation_) continue;
+
+                bool target = n == goalIdx_;
+                if (tile & (TILE_DOOR | TILE_KEY)) {
+                    uint32_t bit = uint32_t(1) << (tile & TILE_BIT_MASK);
+                    if (leg) leg->touched |= bit;
+                    if ((tile & TILE_DOOR) && !(keys & bit)) continue; // door locked
+                    if ((tile & TILE_KEY) && !(keys & bit)) target = true;
+                }
+
+                stamp_[n] = generation_;
+                parentDir_.set(n, static_cast<uint8_t>(d));
+                if (n == stopIdx) return;
+                if (target) {
+                    if (leg) leg->targets.push_back({pointAt(n), dist});
+                    continue;
+                }
+                next_.push_back(n);
+            }
+        }
+        frontier_.swap(next_);
+    }
+}
+
+void KeyGraphSolver::appendLeg(int fromIdx, int toIdx, uint32_t keys, vector<Cell>& path) {
+    search(fromIdx, keys, toIdx, nullptr);
+    size_t first = path.size();
+    for (int cur = toIdx; cur != fromIdx; cur -= dungeon_->offset(parentDir_.get(cur))) {
+        path.push_back(dungeon_->cellAt(cur));
+    }
+    reverse(path.begin() + first, path.end());
+}
+
+const KeyGraphSolver::Leg& KeyGraphSolver::legFrom(int point, uint32_t keys) {
+    for (int i = firstLeg_[point]; i != -1; i = legs_[i].next) {
+        if ((keys & legs_[i].touched) == legs_[i].keysSeen) return legs_[i];
+    }
+    // Pool entries are reused, so their target lists keep their capacity
+    if (legCount_ == legs_.size()) legs_.emplace_back();
+    Leg& leg = legs_[legCount_];
+    leg.touched = 0;
+    leg.next = firstLeg_[point];
+    leg.targets.clear();
+    firstLeg_[point] = static_cast<int>(legCount_++);
+    search(points_[point], keys, -1, &leg);
+    leg.keysSeen = keys & leg.touched;
+    return leg;
+}
+
+bool KeyGraphSolver::solve(const Grid& dungeon, const LevelIndex& level, const TileMap& tiles,
+                           vector<Cell>& path) {
+    path.clear();
+    int startIdx = level.start;
+    int goalIdx = level.goal;
+    if (startIdx == -1 || goalIdx == -1) return false;
+
+    dungeon_ = &dungeon;
+    tiles_ = &tiles;
+    goalIdx_ = goalIdx;
+    if (stamp_.size() < static_cast<size_t>(dungeon.size())) stamp_.resize(dungeon.size(), 0);
+    parentDir_.reserve(dungeon.size());
+
+    // Points of interest: 0 = start, 1 = exit, then every key tile of the
+    // tiles' alphabet
+    points_.assign({startIdx, goalIdx});
+    for (int idx : level.keys) {
+        if (tiles[idx] & TILE_KEY) points_.push_back(idx);
+    }
+    sorted_.clear();
+    for (size_t p = 0; p < points_.size(); p++) sorted_.push_back({points_[p], static_cast<int>(p)});
+    sort(sorted_.begin(), sorted_.end());
+    legCount_ = 0;
+    firstLeg_.assign(points_.size(), -1);
+
+    // Dijkstra over (key set, point), state keys << 32 | point. A new stamp
+    // empties the table without touching it.
+    if (++solveStamp_ == 0) {
+        for (Label& slot : labels_) slot.stamp = 0;
+        solveStamp_ = 1;
+    }
+    labelCount_ = 0;
+    const uint64_t states = tiles.numLayers() * points_.size();
+    directLabels_ = states <= DIRECT_STATES;
+    size_t slots = directLabels_ ? static_cast<size_t>(states) : MIN_HASHED_LABELS;
+    if (labels_.size() < slots) {
+        size_t size = max<size_t>(labels_.size(), 1);
+        while (size < slots) size *= 2;
+        labels_.resize(size);
+    }
+    heap_.clear();
+    auto push = [this](int d, uint64_t state) {
+        heap_.push_back({d, state});
+        push_heap(heap_.begin(), heap_.end(), greater<pair<int, uint64_t>>());
+    };
+
+    label(0).dist = 0;
+    push(0, 0);
+    while (!heap_.empty()) {
+        pop_heap(heap_.begin(), heap_.end(), greater<pair<int, uint64_t>>());
+        pair<int, uint64_t> top = heap_.back();
+        heap_.pop_back();
+        uint64_t state = top.second;
+        if (top.first != label(state).dist) continue;  // stale entry
+        int point = static_cast<int>(state & 0xFFFFFFFF);
+        uint32_t keys = static_cast<uint32_t>(state >> 32);
+
+        if (point == 1) {
+            // Expand the winning route leg by leg
+            route_.assign(1, state);
+            while (route_.back() != 0) route_.push_back(label(route_.back()).prev);
+            reverse(route_.begin(), route_.end());
+
+            path.push_back(dungeon.cellAt(startIdx));
+            for (size_t i = 1; i < route_.size(); i++) {
+                int from = points_[route_[i - 1] & 0xFFFFFFFF];
+                int to = points_[route_[i] & 0xFFFFFFFF];
+                appendLeg(from, to, static_cast<uint32_t>(route_[i - 1] >> 32), path);
+            }
+            return true;
+        }
+
+        // No leg searches while iterating, so the reference stays valid
+        const Leg& leg = legFrom(point, keys);
+        for (const pair<int, int>& target : leg.targets) {
+            uint32_t newKeys = keys;
+            if (target.first != 1) {
+                newKeys |= uint32_t(1) << (tiles[points_[target.first]] & TILE_BIT_MASK);
+            }
+            uint64_t next = (uint64_t(newKeys) << 32) | static_cast<uint32_t>(target.first);
+            int nd = top.first + target.second;
+            Label& reached = label(next);
+            if (nd < reached.dist) {
+                reached.dist = nd;
+                reached.prev = state;
+                push(nd, next);
+            }
+        }
+    }
+    return false;
+}
+
+size_t KeyGraphSolver::bytes() const {
+    size_t targets = 0;
+    for (const Leg& leg : legs_) targets += leg.targets.capacity() * sizeof(pair<int, int>);
+    return stamp_.capacity() * sizeof(uint32_t) + parentDir_.bytes() +
+           (frontier_.capacity() + next_.capacity() + points_.capacity() + firstLeg_.capacity()) * sizeof(int) +
+           sorted_.capacity() * sizeof(pair<int, int>) + labels_.capacity() * sizeof(Label) +
+           heap_.capacity() * sizeof(pair<int, uint64_t>) + route_.capacity() * sizeof(uint64_t) +
+           legs_.capacity() * sizeof(Leg) + targets;
+}
+
+vector<Cell> keyGraphPath(const Grid& dungeon, const LevelIndex& level, const TileMap& tiles) {
+    KeyGraphSolver solver;
+    vector<Cell> path;
+    solver.solve(dungeon, level, tiles, path);
+    return path;
+}
+
+vector<Cell> keyGraphPath(const Grid& dungeon, const TileMap& tiles) {
+    return keyGraphPath(dungeon, indexLevel(dungeon), tiles);
+}
+
+vector<Cell> keyGraphPath(const vector<string>& dungeon) {
+    Grid grid = Grid::fromStrings(dungeon);
+    LevelIndex level = indexLevel(grid);
+    return keyGraphPath(grid, level, TileMap(grid, level, DEFAULT_NUM_KEYS));
+}
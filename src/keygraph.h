@@ -0,0 +1,162 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "tiles.h"
+#include "level_index.h"
+#include "dense.h"
+
+/**
+ * Key-door pathfinding by key-graph compression.
+ *
+ * Instead of searching the full (keys x rows x cols) state space, this solver
+ * works on a small graph whose nodes are the points of interest (S, E and
+ * every key tile). A grid BFS from a point of interest, with the doors of the
+ * current key set open, gives the distance to every other point reachable
+ * before picking up a new key. Dijkstra then runs over (point, key set)
+ * pairs, and only the legs of the winning route are expanded back into
+ * cells.
+ *
+ * Each grid BFS remembers which key/door letters it ran into, so its result
+ * is reused for every key set that agrees on those letters; a leg that never
+ * touches a door is searched once no matter how many keys are held. This
+ * makes the solver much cheaper than bfsPathKeys on big maps with several
+ * keys, and it returns the same shortest length.
+ *
+ * @param dungeon The dungeon grid
+ * @param tiles Tile classes of the dungeon (built with the desired key alphabet)
+ * @return Vector of Cell coordinates representing the path from S to E.
+ *         Returns empty vector if no path exists.
+ */
+std::vector<Cell> keyGraphPath(const Grid& dungeon, const TileMap& tiles);
+
+/**
+ * keyGraphPath with S, E and the key tiles taken from a level index
+ * instead of a scan of the dungeon.
+ *
+ * @param dungeon The dungeon grid
+ * @param level indexLevel of dungeon
+ * @param tiles Tile classes of the dungeon
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> keyGraphPath(const Grid& dungeon, const LevelIndex& level, const TileMap& tiles);
+
+/**
+ * keyGraphPath with a workspace kept between calls, for callers that solve
+ * many dungeons (Solver uses one). The leg-search buffers, the leg cache
+ * and the Dijkstra table only grow, so once they are big enough a solve
+ * allocates nothing. Not thread-safe; one per thread.
+ *
+ * The Dijkstra table holds only the (key set, point) states reached, not
+ * all 2^keys x points of them: while that product is at most
+ * DIRECT_STATES a state is its own slot, beyond it the table is an
+ * open-addressing hash. Slots carry the stamp of the solve that wrote
+ * them, so starting a solve clears nothing.
+ */
+class KeyGraphSolver {
+public:
+    KeyGraphSolver() = default;
+
+    /**
+     * Shortest key-door path, as keyGraphPath.
+     *
+     * @param dungeon The dungeon grid
+     * @param level indexLevel of dungeon
+     * @param tiles Tile classes of the dungeon
+     * @param path Receives the path from S to E; cleared if none exists
+     * @return true if a path exists
+     */
+    bool solve(const Grid& dungeon, const LevelIndex& level, const TileMap& tiles, std::vector<Cell>& path);
+
+    // Bytes currently held by the workspace buffers
+    size_t bytes() const;
+
+    // Largest 2^keys x points indexed directly rather than hashed
+    static const uint64_t DIRECT_STATES = 1 << 16;
+
+private:
+    // Distances found by one leg search from a point of interest; legs of
+    // one point are chained through next
+    struct Leg {
+        uint32_t touched;   // key bits of every key/door tile the search ran into
+        uint32_t keysSeen;  // the searched key set restricted to touched
+        int next;           // older leg of the same point, or -1
+        std::vector<std::pair<int, int>> targets;  // (point index, distance)
+    };
+
+    // Leg from point with key set keys, searched on the first request
+    const Leg& legFrom(int point, uint32_t keys);
+
+    // Grid BFS from fromIdx with keys held; records targets into leg, or
+    // stops at stopIdx when leg is nullptr
+    void search(int fromIdx, uint32_t keys, int stopIdx, Leg* leg);
+
+    // Appends the cells of the shortest leg from fromIdx to toIdx (excluding fromIdx)
+    void appendLeg(int fromIdx, int toIdx, uint32_t keys, std::vector<Cell>& path);
+
+    // Point index of a key tile or the exit
+    int pointAt(int idx) const;
+
+    // Dijkstra label of one state, keys << 32 | point
+    struct Label {
+        uint64_t state;
+        uint64_t prev;   // state the best distance came from
+        int dist;
+        uint32_t stamp;  // solve that wrote the slot; older slots are empty
+    };
+
+    // Label of state, inserted with distance INT_MAX on first use. Inserting
+    // may move the other labels.
+    Label& label(uint64_t state);
+
+    // Hashed table only: doubles the slots, moving this solve's labels over
+    void growLabels();
+
+    const Grid* dungeon_ = nullptr;
+    const TileMap* tiles_ = nullptr;
+    int goalIdx_ = -1;
+
+    std::vector<int> points_;                   // 0 = start, 1 = exit, then key tiles
+    std::vector<std::pair<int, int>> sorted_;   // (cell, point index) by cell
+    std::vector<uint32_t> stamp_;               // generation stamps of the leg searches
+    uint32_t generation_ = 0;
+    PackedArray<2> parentDir_;
+    std::vector<int> frontier_, next_;
+
+    std::vector<Leg> legs_;       // pool: the first legCount_ are in use
+    size_t legCount_ = 0;
+    std::vector<int> firstLeg_;   // per point: newest leg, or -1
+
+    // Dijkstra over (key set, point) states
+    std::vector<Label> labels_;  // power-of-two slot count
+    size_t labelCount_ = 0;      // labels of this solve
+    uint32_t solveStamp_ = 0;
+    bool directLabels_ = true;
+    std::vector<std::pair<int, uint64_t>> heap_;  // (distance, state), min-heap
+    std::vector<uint64_t> route_;
+};
+
+/**
+ * Convenience overload using the default 'a'-'f' key alphabet.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> keyGraphPath(const std::vector<std::string>& dungeon);
+
+/**
+ * Cost model used by bfsPathKeys to pick a solver: layered BFS touches about
+ * openCells * 2^keys states, the key graph up to openCells per leg search
+ * and at least one search per point of interest (S, E and every key tile).
+ * The key graph is picked only when 4 * points <= 2^keys, e.g. with 5
+ * distinct keys on at most 6 key tiles. Small dungeons always use layered
+ * BFS. Big alphabets cost the key graph nothing up front: its table holds
+ * only the states reached (see KeyGraphSolver).
+ *
+ * @param tiles Tile classes of the dungeon
+ * @return true if keyGraphPath is expected to be cheaper than layered BFS
+ */
+bool keyGraphIsCheaper(const TileMap& tiles);
@@ -0,0 +1,63 @@
+#include "level_index.h"
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+// Records the letters among tiles [begin, end)
+static void classify(const char* tiles, size_t begin, size_t end, LevelIndex& index) {
+    for (size_t i = begin; i < end; i++) {
+        char ch = tiles[i];
+        int idx = static_cast<int>(i);
+        if (ch == 'S') {
+            if (index.start == -1) index.start = idx;
+        } else if (ch == 'E') {
+            if (index.goal == -1) index.goal = idx;
+        } else if (ch >= 'a' && ch <= 'z') {
+            index.keys.push_back(idx);
+        } else if (ch >= 'A' && ch <= 'Z') {
+            index.doors.push_back(idx);
+        }
+    }
+}
+
+// Sum of the eight byte lanes of x
+static uint64_t sumLanes(uint64_t x) {
+    const uint64_t evenBytes = 0x00FF00FF00FF00FFull;
+    uint64_t pairs = (x & evenBytes) + ((x >> 8) & evenBytes);  // four 16-bit lanes
+    return (pairs * 0x0001000100010001ull) >> 48;
+}
+
+void indexLevel(const Grid& dungeon, LevelIndex& index) {
+    index.start = index.goal = -1;
+    index.keys.clear();
+    index.doors.clear();
+
+    const char* tiles = dungeon.data();
+    const size_t size = static_cast<size_t>(dungeon.size());
+    const size_t wordsEnd = size & ~size_t(7);
+    uint64_t walls = 0;
+
+    // Walls are counted per byte lane and folded every 255 words, before a
+    // lane can overflow. The wall border is scanned too: it only adds walls.
+    for (size_t i = 0; i < wordsEnd; ) {
+        uint64_t lanes = 0;
+        size_t blockEnd = min(wordsEnd, i + 255 * 8);
+        for (; i < blockEnd; i += 8) {
+            uint64_t word = loadBytes(tiles + i);
+            lanes += bytesEqual(word, '#') >> 7;
+            if (bytesLetter(word)) classify(tiles, i, i + 8, index);
+        }
+        walls += sumLanes(lanes);
+    }
+    for (size_t i = wordsEnd; i < size; i++) walls += tiles[i] == '#';
+    classify(tiles, wordsEnd, size, index);
+
+    index.openCells = static_cast<int>(size - walls);
+}
+
+LevelIndex indexLevel(const Grid& dungeon, pmr::memory_resource* resource) {
+    LevelIndex index(resource);
+    indexLevel(dungeon, index);
+    return index;
+}
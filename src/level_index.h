@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <memory_resource>
+#include "grid.h"
+
+/**
+ * Everything the solvers look up by scanning a dungeon, collected in one
+ * pass: S, E, every key and door tile, and the number of open tiles.
+ * Positions are linear Grid buffer indices in row-major order, so start
+ * and goal are what Grid::find('S') / find('E') return.
+ *
+ * Keys are all of 'a'-'z' and doors all of 'A'-'Z' except 'S' and 'E';
+ * a TileMap narrows them to its key alphabet.
+ */
+struct LevelIndex {
+    int start = -1;               // first 'S', or -1
+    int goal = -1;                // first 'E', or -1
+    int openCells = 0;            // tiles other than '#'
+    std::pmr::vector<int> keys;   // 'a'-'z' tiles
+    std::pmr::vector<int> doors;  // 'A'-'Z' tiles other than 'S' and 'E'
+
+    explicit LevelIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : keys(resource), doors(resource) {}
+
+    bool operator==(const LevelIndex& other) const {
+        return start == other.start && goal == other.goal && openCells == other.openCells &&
+               keys == other.keys && doors == other.doors;
+    }
+    bool operator!=(const LevelIndex& other) const { return !(*this == other); }
+};
+
+/**
+ * Builds the index in one pass over the tile buffer, eight tiles per step.
+ * Each 64-bit word is tested for walls and for letters with byte-wise
+ * compares in the register (no carries cross a byte), so only words that
+ * hold a letter are looked at tile by tile. In a generated dungeon that is
+ * a handful of words.
+ *
+ * @param dungeon The dungeon grid
+ * @param index Receives the index; its buffers are reused
+ */
+void indexLevel(const Grid& dungeon, LevelIndex& index);
+
+/**
+ * indexLevel into a new index.
+ *
+ * @param dungeon The dungeon grid
+ * @param resource Memory resource for the key and door lists
+ * @return Index of the dungeon
+ */
+LevelIndex indexLevel(const Grid& dungeon,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// Byte-wise compares on a 64-bit word: the high bit of each result byte is
+// set when that byte of x matches. Exact for every byte value.
+const uint64_t BYTES_LOW7 = 0x7F7F7F7F7F7F7F7Full;
+const uint64_t BYTES_HIGH = 0x8080808080808080ull;
+const uint64_t BYTES_ONE = 0x0101010101010101ull;
+
+// Bytes equal to ch
+inline uint64_t bytesEqual(uint64_t x, char ch) {
+    uint64_t diff = x ^ (BYTES_ONE * static_cast<uint8_t>(ch));
+    return ~(((diff & BYTES_LOW7) + BYTES_LOW7) | diff | BYTES_LOW7);
+}
+
+// Bytes at least 'A' (every letter; also bytes past ASCII)
+inline uint64_t bytesLetter(uint64_t x) {
+    return (((x & BYTES_LOW7) + BYTES_ONE * (0x80 - 'A')) | x) & BYTES_HIGH;
+}
+
+// Eight tiles of a byte buffer as one word
+inline uint64_t loadBytes(const char* tiles) {
+    uint64_t word;
+    std::memcpy(&word, tiles, sizeof(word));
+    return word;
+}
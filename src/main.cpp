@@ -1,10 +1,29 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <sstream>
+#include <cstdio>
+#include <memory_resource>
+#include <future>
 #include <cassert>
+#include <cctype>
 #include "generator.h"
 #include "solver.h"
 #include "cell.h"
+#include "keygraph.h"
+#include "dungeon_io.h"
+#include "packed_dungeon.h"
+#include "batch_solver.h"
+#include "distance_field.h"
+#include "incremental.h"
+#include "astar.h"
+#include "hpa.h"
+#include "level_index.h"
+#include "tiles.h"
+#include "grid_layout.h"
+#include "huge_pages.h"
+#include "key_placement.h"
+#include "solve_service.h"
 
 using namespace std;
 
@@ -17,8 +36,10 @@ void printDungeon(const vector<string>& dungeon, const string& title = "") {
         cout << title << ":" << endl;
     }
     
-    for (const string& row : dungeon) {
-        cout << row << endl;
+    // One buffered write instead of a flush per row
+    {
+        DungeonWriter out(cout);
+        for (const string& row : dungeon) out.writeRow(row);
     }
     cout << endl;
 }
@@ -43,8 +64,10 @@ void printDungeonWithPath(vector<string> dungeon, const vector<Cell>& path, cons
         }
     }
     
-    for (const string& row : dungeon) {
-        cout << row << endl;
+    // One buffered write instead of a flush per row
+    {
+        DungeonWriter out(cout);
+        for (const string& row : dungeon) out.writeRow(row);
     }
     cout << endl;
 }
@@ -56,32 +79,29 @@ void printDungeonWithPath(vector<string> dungeon, const vector<Cell>& path, cons
  * 3. No step goes through walls
  * 4. Path is non-empty if start and exit exist
  */
-bool validatePath(const vector<string>& dungeon, const vector<Cell>& path) {
+bool validatePath(const Grid& dungeon, const vector<Cell>& path) {
     if (path.empty()) {
         return false;
     }
     
-    Cell start = findPosition(dungeon, 'S');
-    Cell exit = findPosition(dungeon, 'E');
-    
-    if (start.r == -1 || exit.r == -1) {
+    LevelIndex level = indexLevel(dungeon);
+    if (level.start == -1 || level.goal == -1) {
         return false; 
     }
     
-    if (path[0] != start || path[path.size() - 1] != exit) {
+    if (path[0] != dungeon.cellAt(level.start) || path[path.size() - 1] != dungeon.cellAt(level.goal)) {
         return false;
     }
     
     for (size_t i = 0; i < path.size(); i++) {
         const Cell& cell = path[i];
         
-        if (cell.r < 0 || cell.r >= (int)dungeon.size() || 
-            cell.c < 0 || cell.c >= (int)dungeon[0].size()) {
+        if (cell.r < 0 || cell.r >= dungeon.rows() || 
+            cell.c < 0 || cell.c >= dungeon.cols()) {
             return false;
         }
         
-        char cellChar = dungeon[cell.r][cell.c];
-        if (cellChar == '#') {
+        if (dungeon.at(cell.r, cell.c) == '#') {
             return false;
         }
         
@@ -101,6 +121,10 @@ bool validatePath(const vector<string>& dungeon, const vector<Cell>& path) {
     return true;
 }
 
+bool validatePath(const vector<string>& dungeon, const vector<Cell>& path) {
+    return !dungeon.empty() && validatePath(Grid::fromStrings(dungeon), path);
+}
+
 /**
  * Creates a simple test dungeon for basic pathfinding tests.
  */
@@ -335,6 +359,1080 @@ bool testDungeonGeneration() {
     return success;
 }
 
+/**
+ * Test that the key-graph solver finds a path as short as layered key-door BFS.
+ */
+bool testKeyGraphSolver() {
+    cout << "=== Key-Graph Solver Test ===" << endl;
+
+    vector<string> dungeon = createTestDungeonKeys();
+    vector<Cell> layeredPath = bfsPathKeys(dungeon);
+    vector<Cell> graphPath = keyGraphPath(dungeon);
+
+    cout << "Layered BFS length: " << layeredPath.size()
+         << ", key-graph length: " << graphPath.size() << endl;
+
+    bool success = false;
+    if (graphPath.empty()) {
+        cout << "[ERROR] Key-graph solver found no path!" << endl;
+    } else if (!validatePath(dungeon, graphPath)) {
+        cout << "[ERROR] Invalid key-graph path!" << endl;
+    } else if (graphPath.size() != layeredPath.size()) {
+        cout << "[ERROR] Key-graph path is not the shortest!" << endl;
+    } else {
+        cout << "[OK] Key-graph solver matches layered BFS!" << endl;
+        printDungeonWithPath(dungeon, graphPath, "Key-Graph Solution");
+        success = true;
+    }
+
+    // The key graph pays per key tile: one key per letter qualifies, the
+    // same letters spread over many tiles fall back to layered BFS
+    GeneratorOptions options;
+    options.seed = 505;
+    options.keys = MAX_PLACED_KEYS;
+    options.requiredKeys = MAX_PLACED_KEYS;
+    Grid level = generateDungeonGrid(121, 121, options);
+    bool fewPoints = keyGraphIsCheaper(TileMap(level, DEFAULT_NUM_KEYS));
+    vector<Cell> expected = bfsPathKeys(level);
+    for (int idx = 0, spread = 0; idx < level.size() && spread < 40; idx += 97) {
+        if (level[idx] == ' ') {
+            level[idx] = PLACEABLE_KEYS[spread++ % MAX_PLACED_KEYS];
+        }
+    }
+    bool manyPoints = !keyGraphIsCheaper(TileMap(level, DEFAULT_NUM_KEYS)) &&
+                      bfsPathKeys(level).size() <= expected.size();
+    bool model = fewPoints && manyPoints;
+    cout << (model ? "[OK] " : "[ERROR] ") << "Cost model counts key tiles, not just letters" << endl;
+
+    // A chain of 20 key/door pairs beside a big room: 2^20 key sets, of
+    // which the route reaches about 40, so the Dijkstra table must stay small
+    vector<string> chain(121, string(121, '#'));
+    for (int r = 3; r < 120; r++) {
+        for (int c = 1; c < 120; c++) chain[r][c] = ' ';
+    }
+    const string letters = "abcdfghijklmnopqrtuv";  // no 'e' or 's', whose doors are E and S
+    chain[1][1] = 'S';
+    chain[2][1] = ' ';
+    int col = 2;
+    for (char key : letters) {
+        chain[1][col++] = ' ';
+        chain[1][col++] = key;
+        chain[1][col++] = ' ';
+        chain[1][col++] = static_cast<char>(toupper(key));
+    }
+    chain[1][col] = 'E';
+    Grid chainGrid = Grid::fromStrings(chain);
+    LevelIndex chainLevel = indexLevel(chainGrid);
+    TileMap chainTiles(chainGrid, chainLevel, 26);
+    KeyGraphSolver chainSolver;
+    vector<Cell> chainPath;
+    bool chained = keyGraphIsCheaper(chainTiles) &&
+                   chainSolver.solve(chainGrid, chainLevel, chainTiles, chainPath) &&
+                   chainPath.size() == static_cast<size_t>(col) && chainSolver.bytes() < (1 << 20) &&
+                   bfsPathKeys<26>(chain).size() == chainPath.size();
+    cout << (chained ? "[OK] " : "[ERROR] ") << "20 keys: path " << chainPath.size()
+         << ", workspace " << chainSolver.bytes() / 1024 << " KB" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success && model && chained;
+}
+
+/**
+ * Test that every bfsPath search strategy returns a valid shortest path
+ * (same length as the standard BFS) on the test dungeons.
+ */
+bool testSolverStrategies() {
+    cout << "=== Solver Strategy Test ===" << endl;
+
+    const SolverStrategy strategies[] = {
+        SolverStrategy::Bidirectional,
+        SolverStrategy::BitParallel,
+        SolverStrategy::Parallel,
+        SolverStrategy::AStar,
+        SolverStrategy::JumpPoint
+    };
+    const char* names[] = {
+        "Bidirectional",
+        "Bit-parallel",
+        "Parallel",
+        "A*",
+        "Jump point"
+    };
+
+    vector<vector<string>> dungeons = {
+        createTestDungeon1(), createTestDungeon2(), createTestDungeonKeys(),
+        createUnsolvableDungeon(), generateDungeon(41, 41, 30)
+    };
+
+    bool success = true;
+    for (size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++) {
+        bool ok = true;
+        for (const vector<string>& dungeon : dungeons) {
+            vector<Cell> expected = bfsPath(dungeon);
+            vector<Cell> path = bfsPath(dungeon, strategies[s]);
+            if (path.size() != expected.size() ||
+                (!path.empty() && !validatePath(dungeon, path))) {
+                ok = false;
+            }
+        }
+        cout << (ok ? "[OK] " : "[ERROR] ") << names[s] << " matches standard BFS" << endl;
+        success = success && ok;
+    }
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success;
+}
+
+/**
+ * Test that seeded generation is reproducible for every PRNG engine.
+ */
+bool testSeededGeneration() {
+    cout << "=== Seeded Generation Test ===" << endl;
+
+    bool success = true;
+    const RngEngine engines[] = {RngEngine::Xoshiro256, RngEngine::MersenneTwister};
+    for (RngEngine engine : engines) {
+        GeneratorOptions options;
+        options.seed = 12345;
+        options.engine = engine;
+        vector<string> first = generateDungeon(21, 41, options);
+        vector<string> again = generateDungeon(21, 41, options);
+        options.seed = 54321;
+        vector<string> other = generateDungeon(21, 41, options);
+
+        bool ok = first == again && first != other && !bfsPath(first).empty();
+        cout << (ok ? "[OK] " : "[ERROR] ")
+             << (engine == RngEngine::Xoshiro256 ? "xoshiro256**" : "mt19937")
+             << ": same seed gives the same solvable dungeon" << endl;
+        success = success && ok;
+    }
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success;
+}
+
+/**
+ * Test that every maze algorithm produces a connected, solvable dungeon.
+ */
+bool testMazeAlgorithms() {
+    cout << "=== Maze Algorithms Test ===" << endl;
+
+    const MazeAlgorithm algorithms[] = {
+        MazeAlgorithm::Backtracker, MazeAlgorithm::Eller,
+        MazeAlgorithm::Kruskal, MazeAlgorithm::Wilson
+    };
+    const char* names[] = {"Backtracker", "Eller", "Kruskal", "Wilson"};
+
+    bool success = true;
+    for (size_t a = 0; a < sizeof(algorithms) / sizeof(algorithms[0]); a++) {
+        GeneratorOptions options;
+        options.seed = 2024;
+        options.roomRate = 10;
+        options.algorithm = algorithms[a];
+        vector<string> dungeon = generateDungeon(15, 31, options);
+        vector<Cell> path = bfsPath(dungeon);
+
+        bool ok = !path.empty() && validatePath(dungeon, path);
+        cout << (ok ? "[OK] " : "[ERROR] ") << names[a] << " dungeon is solvable" << endl;
+        if (a == 1) printDungeon(dungeon, "Eller Dungeon");
+        success = success && ok;
+    }
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success;
+}
+
+/**
+ * Test that a streamed Eller dungeon matches the in-memory one and reads
+ * back into a solvable Grid.
+ */
+bool testDungeonStreaming() {
+    cout << "=== Dungeon Streaming Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 777;
+    options.algorithm = MazeAlgorithm::Eller;
+    vector<string> expected = generateDungeon(41, 61, options);
+
+    // A tiny chunk forces rows to straddle chunk boundaries on both sides
+    stringstream buffer;
+    {
+        DungeonWriter writer(buffer, 100);
+        streamDungeon(writer, 41, 61, options);
+    }
+    DungeonReader reader(buffer, 37);
+    Grid loaded = readDungeonGrid(reader);
+
+    bool same = loaded.toStrings() == expected;
+    cout << (same ? "[OK] " : "[ERROR] ") << "Streamed dungeon matches generateDungeon" << endl;
+
+    vector<Cell> path = bfsPath(loaded);
+    bool solved = !path.empty() && validatePath(expected, path);
+    cout << (solved ? "[OK] " : "[ERROR] ") << "Loaded grid is solvable (path length "
+         << path.size() << ")" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return same && solved;
+}
+
+/**
+ * Test the packed format: ASCII round trip through a mapped file, and a
+ * solve straight from the mapped wall plane.
+ */
+bool testPackedDungeon() {
+    cout << "=== Packed Dungeon Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 99;
+    vector<string> generated = generateDungeon(61, 121, options);
+    vector<string> keyed = createTestDungeonKeys();
+
+    bool success = true;
+    const vector<string>* dungeons[] = {&generated, &keyed};
+    for (const vector<string>* dungeon : dungeons) {
+        const char* file = "packed_dungeon_test.dpk";
+        vector<uint8_t> bytes = packDungeon(*dungeon, options.seed);
+        bool saved = savePackedDungeon(file, *dungeon, options.seed);
+        bool same = false, solved = false;
+        {
+            MappedDungeon mapped(file);
+            if (mapped.ok()) {
+                same = mapped.view().toStrings() == *dungeon && mapped.view().seed() == options.seed;
+                solved = bfsPathBitParallel(mapped.view()).size() == bfsPath(*dungeon).size();
+            }
+        }
+        remove(file);
+
+        size_t ascii = dungeon->size() * ((*dungeon)[0].size() + 1);
+        bool ok = saved && same && solved;
+        cout << (ok ? "[OK] " : "[ERROR] ") << "Round trip and mapped solve ("
+             << bytes.size() << " bytes packed vs " << ascii << " ASCII)" << endl;
+        success = success && ok;
+    }
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success;
+}
+
+/**
+ * Test that a reused Solver matches bfsPath / bfsPathKeys over a batch,
+ * serially and with one Solver per thread.
+ */
+bool testBatchSolver() {
+    cout << "=== Batch Solver Test ===" << endl;
+
+    // Mixed sizes so the workspace both grows and gets reused
+    vector<vector<string>> dungeons;
+    for (int i = 0; i < 40; i++) {
+        GeneratorOptions options;
+        options.seed = 500 + i;
+        options.algorithm = static_cast<MazeAlgorithm>(i % 4);
+        dungeons.push_back(generateDungeon(11 + (i % 5) * 10, 21 + (i % 3) * 20, options));
+    }
+    dungeons.push_back(createTestDungeonKeys());
+
+    bool success = true;
+    const SolveRules rules[] = {SolveRules::Basic, SolveRules::Keys};
+    for (SolveRules rule : rules) {
+        vector<vector<Cell>> serial(dungeons.size()), parallel(dungeons.size());
+        Solver solver;
+        solver.solveBatch(dungeons.data(), dungeons.size(), serial.data(), rule);
+        solveBatchParallel(dungeons.data(), dungeons.size(), parallel.data(), rule, 4);
+
+        bool ok = true;
+        for (size_t i = 0; i < dungeons.size(); i++) {
+            vector<Cell> expected = rule == SolveRules::Keys ? bfsPathKeys(dungeons[i])
+                                                             : bfsPath(dungeons[i]);
+            ok = ok && serial[i].size() == expected.size() && parallel[i].size() == expected.size();
+            if (rule == SolveRules::Basic && !expected.empty()) {
+                ok = ok && validatePath(dungeons[i], serial[i]);
+            }
+        }
+        cout << (ok ? "[OK] " : "[ERROR] ") << (rule == SolveRules::Keys ? "Keys" : "Basic")
+             << " batch of " << dungeons.size() << " matches single solves (workspace "
+             << solver.bytes() / 1024 << " KB)" << endl;
+        success = success && ok;
+    }
+
+    // Five-key levels go to the Solver's key-graph workspace: a second pass
+    // over the same batch must not grow it
+    vector<vector<string>> keyed;
+    for (int i = 0; i < 4; i++) {
+        GeneratorOptions options;
+        options.seed = 1400 + i;
+        options.keys = MAX_PLACED_KEYS;
+        options.requiredKeys = MAX_PLACED_KEYS;
+        keyed.push_back(generateDungeon(101 + 20 * i, 121, options));
+    }
+    Solver keySolver;
+    vector<vector<Cell>> keyPaths(keyed.size());
+    keySolver.solveBatch(keyed.data(), keyed.size(), keyPaths.data(), SolveRules::Keys);
+    size_t grown = keySolver.bytes();
+    keySolver.solveBatch(keyed.data(), keyed.size(), keyPaths.data(), SolveRules::Keys);
+    bool reused = keySolver.bytes() == grown;
+    for (size_t i = 0; i < keyed.size(); i++) {
+        reused = reused && keyGraphIsCheaper(TileMap(Grid::fromStrings(keyed[i]), DEFAULT_NUM_KEYS)) &&
+                 validatePath(keyed[i], keyPaths[i]) && keyPaths[i].size() == keyGraphPath(keyed[i]).size();
+    }
+    cout << (reused ? "[OK] " : "[ERROR] ") << "Key-graph levels reuse the workspace ("
+         << grown / 1024 << " KB)" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success && reused;
+}
+
+/**
+ * Test that generation and solving run entirely inside a caller's arena:
+ * the arena has no upstream, so any allocation outside it would throw.
+ */
+bool testArenaAllocation() {
+    cout << "=== Arena Allocation Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 31337;
+    vector<string> expected = generateDungeon(31, 61, options);
+    vector<string> keyed = createTestDungeonKeys();
+
+    bool success = false;
+    vector<char> storage(1 << 20);
+    try {
+        pmr::monotonic_buffer_resource arena(storage.data(), storage.size(),
+                                             pmr::null_memory_resource());
+        pmr::vector<pmr::string> dungeon = generateDungeon(31, 61, options, &arena);
+        pmr::vector<Cell> path = bfsPath(dungeon, &arena);
+
+        pmr::vector<pmr::string> keyedRows(&arena);
+        for (const string& row : keyed) keyedRows.emplace_back(row);
+        pmr::vector<Cell> keyPath = bfsPathKeys(keyedRows, &arena);
+
+        bool same = equal(dungeon.begin(), dungeon.end(), expected.begin(), expected.end(),
+                          [](const pmr::string& a, const string& b) { return a == b.c_str(); });
+        bool solved = path.size() == bfsPath(expected).size() && !path.empty();
+        bool keysSolved = keyPath.size() == bfsPathKeys(keyed).size() && !keyPath.empty();
+        success = same && solved && keysSolved;
+        cout << (success ? "[OK] " : "[ERROR] ") << "Arena dungeon matches, paths of length "
+             << path.size() << " and " << keyPath.size() << endl;
+    } catch (const bad_alloc&) {
+        cout << "[ERROR] Allocation escaped the arena" << endl;
+    }
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return success;
+}
+
+/**
+ * Test the distance-only and existence-only queries against the full solvers.
+ */
+bool testDistanceQueries() {
+    cout << "=== Distance Query Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 4242;
+    vector<string> generated = generateDungeon(41, 81, options);
+    vector<string> keyed = createTestDungeonKeys();
+    vector<string> blocked = createUnsolvableDungeon();
+
+    bool basic = bfsDistance(generated) == static_cast<int>(bfsPath(generated).size()) - 1 &&
+                 isSolvable(generated) && !isSolvable(keyed) && !isSolvable(blocked) &&
+                 bfsDistance(blocked) == -1;
+    cout << (basic ? "[OK] " : "[ERROR] ") << "bfsDistance / isSolvable (distance "
+         << bfsDistance(generated) << ")" << endl;
+
+    bool keys = bfsDistanceKeys(keyed) == static_cast<int>(bfsPathKeys(keyed).size()) - 1 &&
+                isSolvableKeys(keyed) && !isSolvableKeys(blocked) &&
+                bfsDistanceKeys(generated) == bfsDistance(generated);
+    cout << (keys ? "[OK] " : "[ERROR] ") << "bfsDistanceKeys / isSolvableKeys (distance "
+         << bfsDistanceKeys(keyed) << ")" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return basic && keys;
+}
+
+/**
+ * Test that one distance field answers queries to many targets, matching
+ * the single-target solvers, and that the cache serves repeats.
+ */
+bool testDistanceField() {
+    cout << "=== Distance Field Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 8080;
+    Grid generated = generateDungeonGrid(31, 61, options);
+    Grid keyed = Grid::fromStrings(createTestDungeonKeys());
+
+    // Every open cell of the generated dungeon, against one field from S
+    DistanceField field(generated, findPosition(generated, 'S'));
+    bool basic = field.distanceTo(findPosition(generated, 'E')) == bfsDistance(generated);
+    for (int r = 0; r < generated.rows() && basic; r++) {
+        for (int c = 0; c < generated.cols() && basic; c++) {
+            int d = field.distanceTo(Cell(r, c));
+            basic = d == static_cast<int>(field.pathTo(Cell(r, c)).size()) - 1;
+            basic = basic && (generated.at(r, c) == '#') == (d == -1);
+        }
+    }
+    cout << (basic ? "[OK] " : "[ERROR] ") << "Basic field matches per-cell paths" << endl;
+
+    DistanceField keyField(keyed, findPosition(keyed, 'S'), SolveRules::Keys);
+    vector<Cell> keyPath = keyField.pathTo(findPosition(keyed, 'E'));
+    bool keys = keyField.distanceTo(findPosition(keyed, 'E')) == bfsDistanceKeys(keyed) &&
+                keyPath.size() == bfsPathKeys(keyed).size();
+    cout << (keys ? "[OK] " : "[ERROR] ") << "Key-layer field reaches E in "
+         << keyField.distanceTo(findPosition(keyed, 'E')) << " moves" << endl;
+
+    DistanceFieldCache cache;
+    uint64_t id = dungeonId(generated);
+    auto first = cache.get(id, generated, findPosition(generated, 'S'));
+    auto again = cache.get(id, generated, findPosition(generated, 'S'));
+    bool cached = first == again && cache.hits() == 1 && cache.misses() == 1;
+    cout << (cached ? "[OK] " : "[ERROR] ") << "Repeated query served from cache" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return basic && keys && cached;
+}
+
+/**
+ * Test that incremental re-solves after wall, floor and door edits match a
+ * fresh solve of the edited dungeon.
+ */
+bool testIncrementalSolver() {
+    cout << "=== Incremental Solver Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 1818;
+    Grid generated = generateDungeonGrid(41, 61, options);
+    IncrementalSolver solver(generated);
+
+    // Alternately break a wall and fill a floor cell; every repaired path
+    // must be as short as a fresh bfsPath on the edited map
+    bool basic = solver.path().size() == bfsPath(generated).size();
+    size_t repaired = 0;
+    int edits = 0;
+    for (int r = 1; r < generated.rows() - 1 && basic; r += 3) {
+        for (int c = 1; c < generated.cols() - 1 && basic; c += 7) {
+            char tile = solver.dungeon().at(r, c);
+            if (tile != '#' && tile != ' ') continue;
+            vector<Cell> path = solver.update({{Cell(r, c), tile == '#' ? ' ' : '#'}});
+            vector<string> edited = solver.dungeon().toStrings();
+            vector<Cell> fresh = bfsPath(edited);
+            basic = path.size() == fresh.size() && (path.empty() || validatePath(edited, path));
+            repaired += solver.lastRepaired();
+            edits++;
+        }
+    }
+    cout << (basic ? "[OK] " : "[ERROR] ") << edits << " edits matched bfsPath, "
+         << (edits ? repaired / edits : 0) << " states repaired per edit" << endl;
+
+    // Keys: a door opened and closed again, then a wall cut off the exit
+    IncrementalSolver keySolver(createTestDungeonKeys(), SolveRules::Keys);
+    bool keys = true;
+    const vector<vector<TileEdit>> keyEdits = {
+        {{Cell(4, 3), ' '}}, {{Cell(4, 3), 'B'}}, {{Cell(5, 4), '#'}}};
+    for (const vector<TileEdit>& edit : keyEdits) {
+        vector<Cell> path = keySolver.update(edit);
+        vector<string> edited = keySolver.dungeon().toStrings();
+        keys = keys && path.size() == bfsPathKeys(edited).size();
+    }
+    keys = keys && keySolver.distance() == -1;
+    cout << (keys ? "[OK] " : "[ERROR] ") << "Key-door edits matched bfsPathKeys" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return basic && keys;
+}
+
+/**
+ * Test the heuristic searches on open-room dungeons, where they should skip
+ * most of the map, and A* over key layers against bfsPathKeys.
+ */
+bool testHeuristicSearch() {
+    cout << "=== Heuristic Search Test ===" << endl;
+
+    bool rooms = true;
+    for (int roomRate : {50, 100}) {
+        GeneratorOptions options;
+        options.seed = 1919;
+        options.roomRate = roomRate;
+        vector<string> dungeon = generateDungeon(61, 81, options);
+        size_t expected = bfsPath(dungeon).size();
+        vector<Cell> astar = astarPath(dungeon);
+        vector<Cell> jps = jpsPath(dungeon);
+        rooms = rooms && astar.size() == expected && validatePath(dungeon, astar) &&
+                jps.size() == expected && validatePath(dungeon, jps);
+    }
+    cout << (rooms ? "[OK] " : "[ERROR] ") << "A* and JPS match BFS on open-room dungeons" << endl;
+
+    bool keys = true;
+    vector<vector<string>> keyDungeons = {createTestDungeonKeys(), createTestDungeon1(),
+                                          createUnsolvableDungeon()};
+    for (const vector<string>& dungeon : keyDungeons) {
+        vector<Cell> path = astarPathKeys(dungeon);
+        keys = keys && path.size() == bfsPathKeys(dungeon).size() &&
+               (path.empty() || validatePath(dungeon, path));
+    }
+    cout << (keys ? "[OK] " : "[ERROR] ") << "Key-layer A* matches bfsPathKeys" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return rooms && keys;
+}
+
+/**
+ * Test HPA* queries against bfsPath, exact with every crossing as an
+ * entrance, and after edits that rebuild only the touched clusters.
+ */
+bool testHierarchicalMap() {
+    cout << "=== Hierarchical Pathfinding Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 2020;
+    options.roomRate = 60;
+    Grid generated = generateDungeonGrid(81, 101, options);
+    vector<string> dungeon = generated.toStrings();
+    size_t expected = bfsPath(generated).size();
+
+    HierarchicalMap compressed(generated);
+    vector<Cell> path = compressed.findPath();
+    bool valid = path.size() >= expected && validatePath(dungeon, path);
+    cout << (valid ? "[OK] " : "[ERROR] ") << compressed.nodeCount() << " entrances in "
+         << compressed.clusterCount() << " clusters, path " << path.size() << " (BFS "
+         << expected << ")" << endl;
+
+    HierarchyOptions exactOptions;
+    exactOptions.exactEntrances = true;
+    HierarchicalMap exact(generated, exactOptions);
+    path = exact.findPath();
+    bool optimal = path.size() == expected && validatePath(dungeon, path);
+    cout << (optimal ? "[OK] " : "[ERROR] ") << "Exact entrances match BFS length" << endl;
+
+    // Wall off a row of cells inside one cluster, then reopen it
+    bool edited = true;
+    for (char tile : {'#', ' '}) {
+        vector<TileEdit> edits;
+        for (int c = 1; c < 8; c++) {
+            if (generated.at(20, c) != '#') edits.push_back({Cell(20, c), tile});
+        }
+        exact.update(edits);
+        vector<string> current = exact.dungeon().toStrings();
+        path = exact.findPath();
+        size_t fresh = bfsPath(current).size();
+        edited = edited && path.size() == fresh && (path.empty() || validatePath(current, path)) &&
+                 exact.lastRebuilt() < exact.clusterCount() / 4;
+    }
+    cout << (edited ? "[OK] " : "[ERROR] ") << "Edits rebuilt " << exact.lastRebuilt() << " of "
+         << exact.clusterCount() << " clusters and match a fresh BFS" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return valid && optimal && edited;
+}
+
+/**
+ * Test that batch generation is identical for any thread count, and that
+ * any level can be regenerated alone from its index.
+ */
+bool testBatchGeneration() {
+    cout << "=== Batch Generation Test ===" << endl;
+
+    const size_t count = 12;
+    const uint64_t baseSeed = 2121;
+    vector<Grid> serial = generateDungeons(count, 25, 35, 20, baseSeed, 1);
+    vector<Grid> parallel = generateDungeons(count, 25, 35, 20, baseSeed, 4);
+
+    bool identical = serial.size() == count && parallel.size() == count;
+    bool solvable = identical;
+    for (size_t i = 0; i < count && identical; i++) {
+        identical = serial[i].toStrings() == parallel[i].toStrings();
+        solvable = solvable && isSolvable(serial[i]);
+    }
+    cout << (identical ? "[OK] " : "[ERROR] ") << "1 and 4 threads produce identical batches" << endl;
+    cout << (solvable ? "[OK] " : "[ERROR] ") << "Every batch dungeon is solvable" << endl;
+
+    GeneratorOptions options;
+    options.seed = batchSeed(baseSeed, 7);
+    bool regenerated = generateDungeonGrid(25, 35, options).toStrings() == serial[7].toStrings() &&
+                       serial[7].toStrings() != serial[8].toStrings();
+    cout << (regenerated ? "[OK] " : "[ERROR] ") << "Level 7 regenerated from its index alone" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return identical && solvable && regenerated;
+}
+
+/**
+ * Test that the solution recorded during generation matches bfsPath for
+ * every maze algorithm, with and without rooms.
+ */
+bool testGeneratedSolution() {
+    cout << "=== Generated Solution Test ===" << endl;
+
+    const MazeAlgorithm algorithms[] = {MazeAlgorithm::Backtracker, MazeAlgorithm::Eller,
+                                        MazeAlgorithm::Kruskal, MazeAlgorithm::Wilson};
+    bool sameDungeon = true, matches = true, treeOk = true;
+    for (MazeAlgorithm algorithm : algorithms) {
+        for (int roomRate : {0, 20}) {
+            GeneratorOptions options;
+            options.seed = 2222;
+            options.roomRate = roomRate;
+            options.algorithm = algorithm;
+            DungeonSolution solution;
+            Grid dungeon = generateDungeonGrid(31, 41, options, solution);
+            sameDungeon = sameDungeon && dungeon.toStrings() == generateDungeonGrid(31, 41, options).toStrings();
+
+            vector<string> rows = dungeon.toStrings();
+            vector<Cell> path = bfsPath(rows);
+            matches = matches && solution.distance == static_cast<int>(path.size()) - 1 &&
+                      solution.path.size() == path.size() && validatePath(rows, solution.path);
+            treeOk = treeOk && solution.treeDistance >= solution.distance &&
+                     (roomRate > 0 || (solution.treeDistance == solution.distance && solution.shortcuts == 0));
+        }
+    }
+    cout << (sameDungeon ? "[OK] " : "[ERROR] ") << "Recording the solution leaves the dungeon unchanged" << endl;
+    cout << (matches ? "[OK] " : "[ERROR] ") << "Recorded distance and path match bfsPath" << endl;
+    cout << (treeOk ? "[OK] " : "[ERROR] ") << "Rooms only shorten the maze distance" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return sameDungeon && matches && treeOk;
+}
+
+/**
+ * Test that distance-based exit placement moves only E, and that a higher
+ * percentile never puts it closer to S.
+ */
+bool testExitPlacement() {
+    cout << "=== Exit Placement Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 2323;
+    options.roomRate = 10;
+    vector<string> corner = generateDungeon(41, 61, options);
+
+    bool wallsKept = true, solved = true, ordered = true;
+    int previous = -1;
+    for (int percentile : {0, 25, 50, 75, 100}) {
+        options.exit = ExitPlacement::Percentile;
+        options.exitPercentile = percentile;
+        DungeonSolution solution;
+        vector<string> dungeon = generateDungeonGrid(41, 61, options, solution).toStrings();
+        for (size_t r = 0; r < dungeon.size(); r++) {
+            for (size_t c = 0; c < dungeon[r].size(); c++) {
+                wallsKept = wallsKept && (dungeon[r][c] == '#') == (corner[r][c] == '#');
+            }
+        }
+        int distance = bfsDistance(dungeon);
+        solved = solved && distance > 0 && distance == solution.distance;
+        ordered = ordered && distance >= previous;
+        previous = distance;
+    }
+    options.exit = ExitPlacement::Farthest;
+    ordered = ordered && bfsDistance(generateDungeon(41, 61, options)) == previous &&
+              previous >= bfsDistance(corner);
+
+    cout << (wallsKept ? "[OK] " : "[ERROR] ") << "Placement changes only the exit" << endl;
+    cout << (solved ? "[OK] " : "[ERROR] ") << "Reported distance matches bfsDistance" << endl;
+    cout << (ordered ? "[OK] " : "[ERROR] ") << "Percentiles order the exit distance; 100 is farthest" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return wallsKept && solved && ordered;
+}
+
+/**
+ * Fewest keys a level can be solved with: every subset of its key tiles is
+ * tried, with the keys left out turned into floor.
+ *
+ * @param dungeon The dungeon to check
+ * @return Smallest number of keys on some solution, or -1 if unsolvable
+ */
+int fewestKeysNeeded(const vector<string>& dungeon) {
+    vector<Cell> keys;
+    for (size_t r = 0; r < dungeon.size(); r++) {
+        for (size_t c = 0; c < dungeon[r].size(); c++) {
+            if (islower(static_cast<unsigned char>(dungeon[r][c]))) keys.push_back(Cell(r, c));
+        }
+    }
+    int fewest = -1;
+    for (uint32_t subset = 0; subset < (1u << keys.size()); subset++) {
+        int count = __builtin_popcount(subset);
+        if (fewest != -1 && count >= fewest) continue;
+        vector<string> trial = dungeon;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (!((subset >> i) & 1)) trial[keys[i].r][keys[i].c] = ' ';
+        }
+        if (!bfsPathKeys(trial).empty()) fewest = count;
+    }
+    return fewest;
+}
+
+/**
+ * Test that generated keys and doors keep the dungeon solvable, leave the
+ * maze itself alone, and make exactly the requested keys necessary.
+ */
+bool testKeyPlacement() {
+    cout << "=== Key Placement Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 2424;
+    options.roomRate = 0;
+    vector<string> plain = generateDungeon(31, 41, options);
+    options.keys = 4;
+    options.requiredKeys = 2;
+    DungeonSolution solution;
+    vector<string> dungeon = generateDungeonGrid(31, 41, options, solution).toStrings();
+
+    bool mazeKept = true;
+    vector<Cell> doors;
+    for (size_t r = 0; r < dungeon.size(); r++) {
+        for (size_t c = 0; c < dungeon[r].size(); c++) {
+            char tile = dungeon[r][c];
+            bool letter = isalpha(static_cast<unsigned char>(tile)) && tile != 'S' && tile != 'E';
+            mazeKept = mazeKept && (letter ? plain[r][c] == ' ' : tile == plain[r][c]);
+            if (letter && isupper(static_cast<unsigned char>(tile))) doors.push_back(Cell(r, c));
+        }
+    }
+    bool counted = static_cast<int>(doors.size()) == solution.keys && solution.keys == 4 &&
+                   solution.requiredKeys == 2;
+
+    vector<Cell> path = bfsPathKeys(dungeon);
+    bool solvable = validatePath(dungeon, path);
+
+    // A door is required when walling it in leaves no solution
+    int required = 0;
+    for (const Cell& door : doors) {
+        vector<string> blocked = dungeon;
+        blocked[door.r][door.c] = '#';
+        if (bfsPathKeys(blocked).empty()) required++;
+    }
+    bool exact = required == solution.requiredKeys;
+
+    // Across sizes, algorithms and requested counts, the fewest keys that
+    // solve the level must be exactly the reported required count
+    int levels = 0, mismatches = 0;
+    for (int seed = 0; seed < 160; seed++) {
+        GeneratorOptions sweep;
+        sweep.seed = 240000 + seed * 7919;
+        sweep.roomRate = (seed % 4) * 10;
+        sweep.algorithm = static_cast<MazeAlgorithm>(seed % 4);
+        sweep.keys = 1 + seed % MAX_PLACED_KEYS;
+        sweep.requiredKeys = (seed / 5) % (MAX_PLACED_KEYS + 2) - 1;
+        int size = 9 + 2 * (seed % 17);
+        DungeonSolution placed;
+        vector<string> level = generateDungeonGrid(size, size + 2 * (seed % 3), sweep, placed).toStrings();
+        levels++;
+        if (fewestKeysNeeded(level) != placed.requiredKeys ||
+            (sweep.requiredKeys >= 0 && placed.requiredKeys > sweep.requiredKeys)) mismatches++;
+    }
+    bool swept = mismatches == 0;
+
+    cout << (mazeKept ? "[OK] " : "[ERROR] ") << "Keys and doors only replace floor" << endl;
+    cout << (counted ? "[OK] " : "[ERROR] ") << "4 pairs placed, 2 of them required" << endl;
+    cout << (solvable ? "[OK] " : "[ERROR] ") << "bfsPathKeys solves the generated level" << endl;
+    cout << (exact ? "[OK] " : "[ERROR] ") << "Exactly the required doors block every route" << endl;
+    cout << (swept ? "[OK] " : "[ERROR] ") << levels - mismatches << "/" << levels
+         << " generated levels need exactly their required keys" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return mazeKept && counted && solvable && exact && swept;
+}
+
+/**
+ * Test the instrumented solvers: the same paths as the plain overloads,
+ * counters that agree with each other, and the JSON export.
+ */
+bool testSolverStats() {
+    cout << "=== Solver Statistics Test ===" << endl;
+
+    GeneratorOptions options;
+    options.seed = 2626;
+    options.roomRate = 20;
+    Grid dungeon = generateDungeonGrid(301, 301, options);
+
+    bool counted = true;
+    const SolverStrategy strategies[] = {SolverStrategy::Standard, SolverStrategy::Bidirectional,
+                                         SolverStrategy::BitParallel, SolverStrategy::Parallel,
+                                         SolverStrategy::AStar, SolverStrategy::JumpPoint};
+    for (SolverStrategy strategy : strategies) {
+        SolverStats stats;
+        vector<Cell> path = bfsPath(dungeon, strategy, stats);
+        counted = counted && !path.empty() && path.size() == bfsPath(dungeon, strategy).size() &&
+                  stats.layerStates.size() == 1 && stats.visited() > 0 && stats.popped > 0 &&
+                  stats.popped <= stats.pushed && stats.maxFrontier > 0 && stats.maxFrontier <= stats.pushed &&
+                  stats.bytesAllocated > 0 && stats.phaseSeconds[static_cast<int>(SolvePhase::Search)] > 0;
+    }
+    cout << (counted ? "[OK] " : "[ERROR] ") << "Every strategy reports consistent counters" << endl;
+
+    // An exhausted BFS pops everything it pushed; reusing stats resets them
+    SolverStats stats;
+    Grid blocked = Grid::fromStrings(createUnsolvableDungeon());
+    bool exhausted = bfsPath(blocked, stats).empty() && stats.pushed == stats.popped;
+    uint64_t pushed = stats.pushed;
+    bfsPath(blocked, stats);
+    exhausted = exhausted && stats.pushed == pushed;
+    cout << (exhausted ? "[OK] " : "[ERROR] ") << "Unsolvable search pops every pushed state" << endl;
+
+    Grid keyed = Grid::fromStrings(createTestDungeonKeys());
+    vector<Cell> keyPath = bfsPathKeys(keyed, stats);
+    bool layered = keyPath.size() == bfsPathKeys(keyed).size() && !stats.keyGraph &&
+                   stats.layerStates.size() > 1 && stats.layerStates[0] > 0 &&
+                   stats.visited() <= keyed.size() * stats.layerStates.size();
+    cout << (layered ? "[OK] " : "[ERROR] ") << "Key search counts states per key layer" << endl;
+
+    string json = toJson(stats);
+    bool exported = json.front() == '{' && json.back() == '}' &&
+                    json.find("\"pushed\":" + to_string(stats.pushed) + ",") != string::npos &&
+                    json.find("\"reconstruct\":") != string::npos;
+    cout << (exported ? "[OK] " : "[ERROR] ") << "JSON export: " << json << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return counted && exhausted && layered && exported;
+}
+
+/**
+ * Test the one-pass level index: the same S and E as Grid::find, the key
+ * and door tiles and open count of a brute-force scan, the index the
+ * generator emits, and the solver overloads that take one.
+ */
+bool testLevelIndex() {
+    cout << "=== Level Index Test ===" << endl;
+
+    // Odd widths leave a tail after the last full word of the buffer
+    bool scanned = true;
+    const vector<vector<string>> samples = {createTestDungeon1(), createTestDungeonKeys(),
+                                            createUnsolvableDungeon(), {"S#E"}, {"#a#", "#A#"}};
+    for (const vector<string>& sample : samples) {
+        Grid grid = Grid::fromStrings(sample);
+        LevelIndex level = indexLevel(grid);
+        vector<int> keys, doors;
+        int open = 0;
+        for (int idx = 0; idx < grid.size(); idx++) {
+            char tile = grid[idx];
+            open += tile != '#';
+            if (tile >= 'a' && tile <= 'z') keys.push_back(idx);
+            if (tile >= 'A' && tile <= 'Z' && tile != 'S' && tile != 'E') doors.push_back(idx);
+        }
+        scanned = scanned && level.start == grid.find('S') && level.goal == grid.find('E') &&
+                  level.openCells == open && vector<int>(level.keys.begin(), level.keys.end()) == keys &&
+                  vector<int>(level.doors.begin(), level.doors.end()) == doors;
+    }
+    cout << (scanned ? "[OK] " : "[ERROR] ") << "Index matches a tile-by-tile scan" << endl;
+
+    bool emitted = true;
+    const MazeAlgorithm algorithms[] = {MazeAlgorithm::Backtracker, MazeAlgorithm::Eller,
+                                        MazeAlgorithm::Kruskal, MazeAlgorithm::Wilson};
+    for (MazeAlgorithm algorithm : algorithms) {
+        for (int keys = 0; keys <= 4; keys += 2) {
+            GeneratorOptions options;
+            options.seed = 2727 + keys;
+            options.algorithm = algorithm;
+            options.keys = keys;
+            options.roomRate = keys * 10;
+            options.exit = keys == 2 ? ExitPlacement::Farthest : ExitPlacement::Corner;
+            DungeonSolution solution;
+            Grid grid = generateDungeonGrid(41, 57, options, solution);
+            emitted = emitted && solution.level == indexLevel(grid) &&
+                      static_cast<int>(solution.level.doors.size()) == solution.keys;
+        }
+    }
+    DungeonSolution tiny;
+    generateDungeonGrid(3, 3, GeneratorOptions(), tiny);
+    emitted = emitted && tiny.level.start == -1 && tiny.level.openCells == 1;
+    cout << (emitted ? "[OK] " : "[ERROR] ") << "Generator emits the index of what it placed" << endl;
+
+    GeneratorOptions options;
+    options.seed = 2727;
+    options.keys = 3;
+    DungeonSolution solution;
+    Grid dungeon = generateDungeonGrid(61, 61, options, solution);
+    TileMap tiles(dungeon, solution.level, DEFAULT_NUM_KEYS);
+    vector<Cell> keyPath = bfsPathKeys(dungeon, solution.level);
+    bool consumed = tiles.openCells() == TileMap(dungeon, DEFAULT_NUM_KEYS).openCells() &&
+                    keyPath.size() == bfsPathKeys(dungeon).size() && validatePath(dungeon, keyPath) &&
+                    keyGraphPath(dungeon, solution.level, tiles).size() == keyPath.size();
+    options.keys = 0;
+    dungeon = generateDungeonGrid(61, 61, options, solution);
+    consumed = consumed && bfsPath(dungeon, solution.level).size() == solution.path.size();
+    cout << (consumed ? "[OK] " : "[ERROR] ") << "Solvers take the index instead of scanning" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return scanned && emitted && consumed;
+}
+
+/**
+ * Test the tiled grid layout: tiles, cells and steps that translate back
+ * to the Grid across block edges, the same paths as the row-major search,
+ * the size-based choice and huge-page backed buffers.
+ */
+bool testGridLayouts() {
+    cout << "=== Grid Layout Test ===" << endl;
+
+    // Sizes chosen so the padded grid ends partway into a block
+    GeneratorOptions options;
+    options.seed = 2828;
+    options.keys = 3;
+    Grid dungeon = generateDungeonGrid(131, 71, options);
+    TiledGrid tiles(dungeon);
+    bool mapped = true;
+    for (int idx = 0; idx < dungeon.size(); idx++) {
+        int tiled = tiles.fromGrid(idx);
+        mapped = mapped && tiles[tiled] == dungeon[idx] && tiles.cellAt(tiled) == dungeon.cellAt(idx);
+        Cell cell = dungeon.cellAt(idx);
+        if (!dungeon.inBounds(cell.r, cell.c)) continue;
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            mapped = mapped && tiles.neighbor(tiled, d) == tiles.fromGrid(idx + dungeon.offset(d));
+        }
+    }
+    cout << (mapped ? "[OK] " : "[ERROR] ") << "Tiled indices and steps match the grid" << endl;
+
+    bool same = true;
+    options.keys = 0;
+    const int sizes[][2] = {{131, 71}, {63, 63}, {65, 129}, {301, 301}};
+    for (const auto& size : sizes) {
+        Grid grid = generateDungeonGrid(size[0], size[1], options);
+        vector<Cell> tiled = bfsPath(grid, GridLayout::Tiled);
+        same = same && !tiled.empty() && tiled == bfsPath(grid, GridLayout::RowMajor);
+    }
+    Grid blocked = Grid::fromStrings(createUnsolvableDungeon());
+    Grid doors = Grid::fromStrings(createTestDungeonKeys());
+    same = same && bfsPath(blocked, GridLayout::Tiled).empty() &&
+           bfsPath(doors, GridLayout::Tiled) == bfsPath(doors, GridLayout::RowMajor);
+    cout << (same ? "[OK] " : "[ERROR] ") << "Tiled search returns the row-major path" << endl;
+
+    Grid large(2900, 2900);
+    bool chosen = chooseLayout(dungeon) == GridLayout::RowMajor && chooseLayout(large) == GridLayout::Tiled &&
+                  chooseLayout(large, GridLayout::RowMajor) == GridLayout::RowMajor;
+    cout << (chosen ? "[OK] " : "[ERROR] ") << "Auto picks tiles only for large grids" << endl;
+
+    // 3 MiB buffers are mapped on huge pages, smaller ones come from the heap
+    pmr::vector<int> buffer(3 << 18, 7, hugePageResource());
+    Grid pooled = generateDungeonGrid(301, 301, options, hugePageResource());
+    bool huge = buffer[0] == 7 && buffer.back() == 7 &&
+                bfsPath(pooled, hugePageResource()).size() == bfsPath(pooled).size();
+    cout << (huge ? "[OK] " : "[ERROR] ") << "Huge-page resource backs grids and solves" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return mapped && same && chosen && huge;
+}
+
+/**
+ * Test the compile-time kernel variants: 4-connected instantiations agree
+ * with each other, 8-connected ones take diagonals through open tiles only
+ * and are never longer.
+ */
+bool testBfsKernel() {
+    cout << "=== BFS Kernel Test ===" << endl;
+
+    // In an open room a diagonal step covers one row and one column
+    Grid room = Grid::fromStrings({"S     ", "      ", "      ", "     E"});
+    vector<Cell> straight = bfsPath(room, Connectivity::Four);
+    vector<Cell> diagonal = bfsPath(room, Connectivity::Eight);
+    bool open = straight.size() == 9 && diagonal.size() == 6 && diagonal.front() == Cell(0, 0) &&
+                diagonal.back() == Cell(3, 5);
+    cout << (open ? "[OK] " : "[ERROR] ") << "Open room: " << straight.size() - 1 << " moves 4-connected, "
+         << diagonal.size() - 1 << " moves 8-connected" << endl;
+
+    // A diagonal may not squeeze between two walls or past one
+    bool corners = bfsPath(Grid::fromStrings({"S#", "#E"}), Connectivity::Eight).empty() &&
+                   bfsPath(Grid::fromStrings({"S ", "#E"}), Connectivity::Eight).size() == 3 &&
+                   bfsPath(Grid::fromStrings({"S ", "AE"}), Connectivity::Eight).size() == 3 &&
+                   bfsPathKeys(Grid::fromStrings({"Sa", "AE"}), Connectivity::Eight).size() == 3;
+    cout << (corners ? "[OK] " : "[ERROR] ") << "Diagonals never cut a wall or door corner" << endl;
+
+    bool agree = true;
+    for (int seed = 0; seed < 8; seed++) {
+        GeneratorOptions options;
+        options.seed = 2929 + seed;
+        options.roomRate = 10 * seed;
+        options.keys = seed % 4;
+        options.requiredKeys = seed % 4;
+        Grid dungeon = generateDungeonGrid(41, 61, options);
+        vector<Cell> four = bfsPathKeys(dungeon, Connectivity::Four);
+        vector<Cell> eight = bfsPathKeys(dungeon, Connectivity::Eight);
+        bool kingMoves = !eight.empty();
+        for (size_t i = 1; i < eight.size(); i++) {
+            int dr = abs(eight[i].r - eight[i - 1].r), dc = abs(eight[i].c - eight[i - 1].c);
+            kingMoves = kingMoves && max(dr, dc) == 1 && dungeon.at(eight[i].r, eight[i].c) != '#';
+        }
+        agree = agree && four.size() == bfsPathKeys(dungeon).size() && validatePath(dungeon, four) &&
+                bfsDistanceKeys(dungeon) == static_cast<int>(four.size()) - 1 && kingMoves &&
+                eight.size() <= four.size() && bfsPath(dungeon, Connectivity::Eight).size() <= bfsPath(dungeon).size();
+    }
+    cout << (agree ? "[OK] " : "[ERROR] ") << "Kernel variants agree on generated levels" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return open && corners && agree;
+}
+
+/**
+ * Test the solve service: concurrent requests get shortest paths, each
+ * distinct (map, goal) is searched once, and repeats come from the cache.
+ */
+bool testSolveService() {
+    cout << "=== Solve Service Test ===" << endl;
+
+    vector<Grid> dungeons;
+    for (int seed = 0; seed < 4; seed++) {
+        GeneratorOptions options;
+        options.seed = 3030 + seed;
+        options.roomRate = 15;
+        options.keys = seed % 3;
+        options.requiredKeys = seed % 3;
+        dungeons.push_back(generateDungeonGrid(41, 61, options));
+    }
+
+    // Every map asked for eight times under each rule set, interleaved
+    SolveService service(4);
+    vector<future<vector<Cell>>> basic, keys;
+    for (int round = 0; round < 8; round++) {
+        for (const Grid& dungeon : dungeons) {
+            basic.push_back(service.submit(dungeon));
+            keys.push_back(service.submit(dungeon, SolveRules::Keys));
+        }
+    }
+    bool paths = true;
+    for (size_t i = 0; i < basic.size(); i++) {
+        const Grid& dungeon = dungeons[i % dungeons.size()];
+        paths = paths && basic[i].get().size() == bfsPath(dungeon).size() &&
+                keys[i].get().size() == bfsPathKeys(dungeon).size();
+    }
+    SolveServiceStats afterFirst = service.stats();
+    bool once = afterFirst.solvedPaths == 2 * dungeons.size() && afterFirst.submitted == 64;
+    cout << (paths ? "[OK] " : "[ERROR] ") << "64 concurrent requests match bfsPath / bfsPathKeys" << endl;
+    cout << (once ? "[OK] " : "[ERROR] ") << afterFirst.solvedPaths << " searches for 8 distinct levels ("
+         << afterFirst.joined << " joined a batch, " << afterFirst.cacheHits << " cache hits)" << endl;
+
+    // Several goals on one map share a distance field
+    const Grid& map = dungeons[0];
+    DistanceField field(map, findPosition(map, 'S'));
+    vector<Cell> goals;
+    for (int r = 1; r < map.rows() && goals.size() < 6; r += 7) {
+        for (int c = 1; c < map.cols() && goals.size() < 6; c += 11) {
+            if (map.at(r, c) != '#') goals.push_back(Cell(r, c));
+        }
+    }
+    vector<future<vector<Cell>>> toGoals;
+    for (Cell goal : goals) toGoals.push_back(service.submit(map, goal));
+    bool goalPaths = !goals.empty();
+    for (size_t i = 0; i < goals.size(); i++) {
+        vector<Cell> path = toGoals[i].get();
+        goalPaths = goalPaths && static_cast<int>(path.size()) - 1 == field.distanceTo(goals[i]) &&
+                    (path.empty() || path.back() == goals[i]);
+    }
+    cout << (goalPaths ? "[OK] " : "[ERROR] ") << goals.size() << " goals on one map match its distance field"
+         << endl;
+
+    // The same levels again (a fresh copy of the text too) are only lookups
+    vector<future<vector<Cell>>> repeats;
+    for (const Grid& dungeon : dungeons) {
+        repeats.push_back(service.submit(dungeon));
+        repeats.push_back(service.submit(dungeon.toStrings(), SolveRules::Keys));
+    }
+    for (auto& repeat : repeats) repeat.get();
+    SolveServiceStats stats = service.stats();
+    bool cached = stats.cacheHits == afterFirst.cacheHits + repeats.size() &&
+                  stats.solvedPaths == afterFirst.solvedPaths + goals.size();
+    bool latency = stats.p50Seconds >= 0 && stats.p50Seconds <= stats.p99Seconds && stats.p99Seconds > 0;
+    cout << (cached ? "[OK] " : "[ERROR] ") << "Repeated levels served from the cache" << endl;
+    cout << (latency ? "[OK] " : "[ERROR] ") << "Latency p50 " << stats.p50Seconds * 1e6 << " us, p99 "
+         << stats.p99Seconds * 1e6 << " us" << endl;
+
+    cout << "--------------------------------------------------" << endl << endl;
+    return paths && once && goalPaths && cached && latency;
+}
+
 /**
  * Main function that runs all test cases.
  */
@@ -345,23 +1443,89 @@ int main() {
     cout << "[TIP] Safety mechanisms will prevent infinite loops and provide guidance." << endl << endl;
     
     // Run all test cases and track progress
-    int totalTests = 5;
+    int totalTests = 27;
     int passedTests = 0;
     
-    cout << "Running test 1/5..." << endl;
+    cout << "Running test 1/27..." << endl;
     if (testBasicPathfinding()) passedTests++;
     
-    cout << "Running test 2/5..." << endl;
+    cout << "Running test 2/27..." << endl;
     if (testComplexPathfinding()) passedTests++;
     
-    cout << "Running test 3/5..." << endl;
+    cout << "Running test 3/27..." << endl;
     if (testKeyDoorPathfinding()) passedTests++;
     
-    cout << "Running test 4/5..." << endl;
+    cout << "Running test 4/27..." << endl;
     if (testUnsolvableDungeon()) passedTests++;
     
-    cout << "Running test 5/5..." << endl;
+    cout << "Running test 5/27..." << endl;
     if (testDungeonGeneration()) passedTests++;
+
+    cout << "Running test 6/27..." << endl;
+    if (testKeyGraphSolver()) passedTests++;
+
+    cout << "Running test 7/27..." << endl;
+    if (testSolverStrategies()) passedTests++;
+
+    cout << "Running test 8/27..." << endl;
+    if (testSeededGeneration()) passedTests++;
+
+    cout << "Running test 9/27..." << endl;
+    if (testMazeAlgorithms()) passedTests++;
+
+    cout << "Running test 10/27..." << endl;
+    if (testDungeonStreaming()) passedTests++;
+
+    cout << "Running test 11/27..." << endl;
+    if (testPackedDungeon()) passedTests++;
+
+    cout << "Running test 12/27..." << endl;
+    if (testBatchSolver()) passedTests++;
+
+    cout << "Running test 13/27..." << endl;
+    if (testArenaAllocation()) passedTests++;
+
+    cout << "Running test 14/27..." << endl;
+    if (testDistanceQueries()) passedTests++;
+
+    cout << "Running test 15/27..." << endl;
+    if (testDistanceField()) passedTests++;
+
+    cout << "Running test 16/27..." << endl;
+    if (testIncrementalSolver()) passedTests++;
+
+    cout << "Running test 17/27..." << endl;
+    if (testHeuristicSearch()) passedTests++;
+
+    cout << "Running test 18/27..." << endl;
+    if (testHierarchicalMap()) passedTests++;
+
+    cout << "Running test 19/27..." << endl;
+    if (testBatchGeneration()) passedTests++;
+
+    cout << "Running test 20/27..." << endl;
+    if (testGeneratedSolution()) passedTests++;
+
+    cout << "Running test 21/27..." << endl;
+    if (testExitPlacement()) passedTests++;
+
+    cout << "Running test 22/27..." << endl;
+    if (testKeyPlacement()) passedTests++;
+
+    cout << "Running test 23/27..." << endl;
+    if (testSolverStats()) passedTests++;
+
+    cout << "Running test 24/27..." << endl;
+    if (testLevelIndex()) passedTests++;
+
+    cout << "Running test 25/27..." << endl;
+    if (testGridLayouts()) passedTests++;
+
+    cout << "Running test 26/27..." << endl;
+    if (testBfsKernel()) passedTests++;
+
+    cout << "Running test 27/27..." << endl;
+    if (testSolveService()) passedTests++;
     
     // Display test progress summary
     cout << "================================================" << endl;
@@ -0,0 +1,389 @@
+#pragma once
+#include <vector>
+#include <memory_resource>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "grid.h"
+#include "generator.h"
+#include "rng.h"
+
+/**
+ * Maze carving algorithms used by generateDungeon. All of them carve a
+ * perfect maze over the odd (row, col) cells of a rows x cols grid (both
+ * odd) that starts as solid wall, and all draw randomness from a caller
+ * supplied generator, so output depends only on the seed.
+ *
+ * They are templates on the generator type so the hot loops call the
+ * engine directly; generator.cpp instantiates them.
+ */
+
+// Directions: up, down, left, right — two steps to allow walls between paths
+const int CARVE_DIRECTIONS[4][2] = {
+    {-2, 0}, {2, 0}, {0, -2}, {0, 2}
+};
+
+// One cell on the backtracking stack: its shuffled direction order and how
+// many of those directions have been tried so far
+struct CarveFrame {
+    int row, col;
+    uint8_t order[4];
+    uint8_t next;
+};
+
+// Starts a stack frame for (row, col), shuffling its directions in place
+template <typename Rng>
+CarveFrame makeCarveFrame(int row, int col, Rng& rng) {
+    CarveFrame frame{row, col, {0, 1, 2, 3}, 0};
+    std::shuffle(frame.order, frame.order + 4, rng);
+    return frame;
+}
+
+/**
+ * Backtracking maze generation with an explicit stack, so carving a huge
+ * grid cannot overflow the thread stack. Visits cells and draws random
+ * numbers in exactly the same order as the recursive formulation.
+ * Long winding corridors, few branches.
+ *
+ * If depth is given (one entry per maze cell, row-major over the odd
+ * (row, col) cells), it also records each cell's distance in moves from
+ * (1, 1) along the maze. The stack is exactly the tree path to the cell
+ * being carved, so its height gives the depth with one store per cell.
+ */
+template <typename Rng>
+void carveBacktracker(Grid& dungeon, Rng& rng, uint32_t* depth = nullptr) {
+    const int rows = dungeon.rows(), cols = dungeon.cols();
+    dungeon.at(1, 1) = ' ';  // Start carving from top-left
+    const int width = (cols - 1) / 2;
+    if (depth) depth[0] = 0;
+
+    std::pmr::vector<CarveFrame> stack(dungeon.resource());  // scratch shares the grid's arena
+    stack.push_back(makeCarveFrame(1, 1, rng));
+
+    while (!stack.empty()) {
+        CarveFrame& frame = stack.back();
+        if (frame.next == 4) {
+            stack.pop_back();  // all directions tried: backtrack
+            continue;
+        }
+        const int* dir = CARVE_DIRECTIONS[frame.order[frame.next++]];
+        int newRow = frame.row + dir[0];
+        int newCol = frame.col + dir[1];
+
+        if (isValidCell(newRow, newCol, rows, cols) && dungeon.at(newRow, newCol) == '#') {
+            carvePassage(dungeon, frame.row, frame.col, newRow, newCol);
+            if (depth) depth[(newRow / 2) * width + newCol / 2] = static_cast<uint32_t>(2 * stack.size());
+            stack.push_back(makeCarveFrame(newRow, newCol, rng));  // invalidates frame
+        }
+    }
+}
+
+/**
+ * Eller's algorithm: produces the dungeon one row at a time while keeping
+ * only O(cols) state (the set label of each cell in the current row), so it
+ * can stream arbitrarily tall dungeons. Each call to next() yields one
+ * dungeon row, border rows included.
+ */
+template <typename Rng>
+class EllerRows {
+public:
+    EllerRows(int rows, int cols, Rng& rng)
+        : rows_(rows), cols_(cols), width_((cols - 1) / 2), height_((rows - 1) / 2), rng_(rng),
+          label_(width_), root_(width_), parent_(width_), members_(width_), seen_(width_),
+          pick_(width_), down_(width_), used_(width_) {
+        for (int j = 0; j < width_; j++) label_[j] = j;
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    /**
+     * Writes the next dungeon row into out (resized to cols).
+     * @return false once all rows have been produced
+     */
+    bool next(std::string& out) {
+        if (emitted_ == rows_) return false;
+        int r = emitted_++;
+        if (r == 0 || r == rows_ - 1) {
+            out.assign(cols_, '#');
+        } else if (r % 2 == 1) {
+            cellRow((r - 1) / 2, out);
+        } else {
+            out = wallRow_;  // south walls computed together with the cell row above
+        }
+        return true;
+    }
+
+private:
+    int find(int x) {
+        while (parent_[x] != x) x = parent_[x] = parent_[parent_[x]];
+        return x;
+    }
+
+    // Carves cell row i (east walls) and decides its south openings
+    void cellRow(int i, std::string& out) {
+        bool last = i == height_ - 1;
+        out.assign(cols_, '#');
+        for (int j = 0; j < width_; j++) {
+            out[2 * j + 1] = ' ';
+            parent_[label_[j]] = label_[j];
+        }
+
+        // Horizontal phase: randomly join neighbors from different sets
+        // (the last row joins all of them so the maze is connected)
+        for (int j = 0; j + 1 < width_; j++) {
+            int a = find(label_[j]), b = find(label_[j + 1]);
+            if (a == b) continue;
+            if (last || randomBelow(rng_, 2)) {
+                parent_[b] = a;
+                out[2 * j + 2] = ' ';
+            }
+        }
+        if (last) return;
+
+        // Vertical phase: every set must open downward at least once
+        for (int j = 0; j < width_; j++) {
+            root_[j] = find(label_[j]);
+            members_[root_[j]] = 0;
+            seen_[root_[j]] = 0;
+            pick_[root_[j]] = -1;
+            used_[j] = 0;
+        }
+        for (int j = 0; j < width_; j++) {
+            down_[j] = static_cast<uint8_t>(randomBelow(rng_, 2));
+            members_[root_[j]]++;
+            if (down_[j]) pick_[root_[j]] = -2;  // already has an opening
+        }
+        for (int j = 0; j < width_; j++) {
+            int root = root_[j];
+            if (pick_[root] == -1) pick_[root] = static_cast<int>(randomBelow(rng_, members_[root]));
+            if (pick_[root] >= 0 && seen_[root]++ == pick_[root]) down_[j] = 1;
+        }
+
+        // Cells that open downward keep their set; the rest start new ones
+        wallRow_.assign(cols_, '#');
+        for (int j = 0; j < width_; j++) {
+            if (down_[j]) {
+                wallRow_[2 * j + 1] = ' ';
+                used_[root_[j]] = 1;
+            }
+        }
+        int fresh = 0;
+        for (int j = 0; j < width_; j++) {
+            if (down_[j]) {
+                label_[j] = root_[j];
+            } else {
+                while (used_[fresh]) fresh++;
+                used_[fresh] = 1;
+                label_[j] = fresh;
+            }
+        }
+    }
+
+    int rows_, cols_, width_, height_;
+    int emitted_ = 0;
+    Rng& rng_;
+    std::vector<int> label_, root_, parent_, members_, seen_, pick_;
+    std::vector<uint8_t> down_, used_;
+    std::string wallRow_;
+};
+
+// Runs Eller's algorithm into a grid
+template <typename Rng>
+void carveEller(Grid& dungeon, Rng& rng) {
+    EllerRows<Rng> rows(dungeon.rows(), dungeon.cols(), rng);
+    std::string row;
+    for (int r = 0; rows.next(row); r++) {
+        std::copy(row.begin(), row.end(), &dungeon.at(r, 0));
+    }
+}
+
+// Union-find over a flat array with path halving and union by size
+class FlatUnionFind {
+public:
+    explicit FlatUnionFind(int size,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : parent_(size, resource), size_(size, 1, resource) {
+        for (int i = 0; i < size; i++) parent_[i] = i;
+    }
+
+    int find(int x) {
+        while (parent_[x] != x) x = parent_[x] = parent_[parent_[x]];
+        return x;
+    }
+
+    // Joins the sets of a and b; returns false if they were already joined
+    bool unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (size_[a] < size_[b]) std::swap(a, b);
+        parent_[b] = a;
+        size_[a] += size_[b];
+        return true;
+    }
+
+private:
+    std::pmr::vector<int> parent_, size_;
+};
+
+/**
+ * Randomized Kruskal: shuffles every wall between two cells and removes the
+ * ones that join different components. Uniformly short dead ends, lots of
+ * branching.
+ */
+template <typename Rng>
+void carveKruskal(Grid& dungeon, Rng& rng) {
+    const int width = (dungeon.cols() - 1) / 2, height = (dungeon.rows() - 1) / 2;
+
+    // Wall w: cell w / 2, toward the east neighbor (even w) or the south one
+    std::pmr::vector<int> walls(dungeon.resource());
+    walls.reserve(static_cast<size_t>(width) * height * 2);
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            dungeon.at(2 * i + 1, 2 * j + 1) = ' ';
+            int cell = i * width + j;
+            if (j + 1 < width) walls.push_back(cell * 2);
+            if (i + 1 < height) walls.push_back(cell * 2 + 1);
+        }
+    }
+    for (size_t k = walls.size(); k > 1; k--) {
+        std::swap(walls[k - 1], walls[randomBelow(rng, static_cast<uint32_t>(k))]);
+    }
+
+    FlatUnionFind sets(width * height, dungeon.resource());
+    for (int wall : walls) {
+        int cell = wall / 2;
+        bool south = wall & 1;
+        int other = cell + (south ? width : 1);
+        if (sets.unite(cell, other)) {
+            int i = cell / width, j = cell % width;
+            dungeon.at(2 * i + 1 + (south ? 1 : 0), 2 * j + 1 + (south ? 0 : 1)) = ' ';
+        }
+    }
+}
+
+/**
+ * Wilson's algorithm: loop-erased random walks from each unvisited cell
+ * until they hit the tree. Produces a uniformly random spanning tree, so it
+ * is unbiased between corridor-heavy and branch-heavy layouts.
+ */
+template <typename Rng>
+void carveWilson(Grid& dungeon, Rng& rng) {
+    const int width = (dungeon.cols() - 1) / 2, height = (dungeon.rows() - 1) / 2;
+    const int cells = width * height;
+    const int step[4] = {-width, width, -1, 1};  // same order as CARVE_DIRECTIONS
+
+    std::pmr::vector<uint8_t> inTree(cells, 0, dungeon.resource());
+    std::pmr::vector<uint8_t> walkDir(cells, 0, dungeon.resource());
+    inTree[0] = 1;
+    dungeon.at(1, 1) = ' ';
+
+    for (int origin = 0; origin < cells; origin++) {
+        if (inTree[origin]) continue;
+
+        // Random walk, remembering only the last exit from each cell; this
+        // erases loops implicitly
+        for (int cur = origin; !inTree[cur]; ) {
+            int i = cur / width, j = cur % width;
+            int d;
+            do {
+                d = static_cast<int>(randomBelow(rng, 4));
+            } while ((d == 0 && i == 0) || (d == 1 && i == height - 1) ||
+                     (d == 2 && j == 0) || (d == 3 && j == width - 1));
+            walkDir[cur] = static_cast<uint8_t>(d);
+            cur += step[d];
+        }
+
+        // Replay the loop-erased walk, carving it into the tree
+        for (int cur = origin; !inTree[cur]; cur += step[walkDir[cur]]) {
+            int i = cur / width, j = cur % width;
+            const int* dir = CARVE_DIRECTIONS[walkDir[cur]];
+            inTree[cur] = 1;
+            dungeon.at(2 * i + 1, 2 * j + 1) = ' ';
+            dungeon.at(2 * i + 1 + dir[0] / 2, 2 * j + 1 + dir[1] / 2) = ' ';
+        }
+    }
+}
+
+/**
+ * Number of walls RoomPuncher knocks out of a rows x cols perfect maze:
+ * roomRate% of the cell count (none below 0%), capped at the walls still
+ * standing between cells.
+ *
+ * @param rows Dungeon rows (odd)
+ * @param cols Dungeon columns (odd)
+ * @param roomRate Percentage of the cell count to punch
+ * @return Walls punched
+ */
+inline int64_t roomsToPunch(int rows, int cols, int roomRate) {
+    int64_t width = (cols - 1) / 2, height = (rows - 1) / 2;
+    // A perfect maze removed (cells - 1) of the walls between cells
+    int64_t innerWalls = height * (width - 1) + (height - 1) * width;
+    int64_t remaining = std::max<int64_t>(0, innerWalls - (width * height - 1));
+    return std::min<int64_t>(remaining, width * height * std::max(roomRate, 0) / 100);
+}
+
+/**
+ * Room punching pass shared by every algorithm. Picks exactly `rooms` of
+ * the walls that still separate two maze cells, uniformly at random, and
+ * knocks them out. Candidates are visited in row-major order with Vitter's
+ * sequential sampling (Method A), so the pass can run one row at a time as
+ * rows are produced, and it draws only one random number per punched wall.
+ */
+template <typename Rng>
+class RoomPuncher {
+public:
+    RoomPuncher(int rows, int cols, int roomRate, Rng& rng) : rows_(rows), rng_(rng) {
+        int64_t width = (cols - 1) / 2, height = (rows - 1) / 2;
+        int64_t innerWalls = height * (width - 1) + (height - 1) * width;
+        remaining_ = std::max<int64_t>(0, innerWalls - (width * height - 1));
+        needed_ = roomsToPunch(rows, cols, roomRate);
+        if (needed_ > 0) skip_ = nextSkip();
+    }
+
+    // Punches the chosen walls of dungeon row r (cols characters)
+    void punchRow(char* row, int r, int cols) {
+        punchRow(row, r, cols, [](int) {});
+    }
+
+    // Same, calling onPunch(c) after each wall it opens
+    template <typename OnPunch>
+    void punchRow(char* row, int r, int cols, OnPunch&& onPunch) {
+        if (needed_ == 0 || r == 0 || r == rows_ - 1) return;
+        // Walls between cells: even columns of cell rows, odd columns of wall rows
+        for (int c = (r % 2 == 1) ? 2 : 1; c < cols - 1; c += 2) {
+            if (row[c] != '#') continue;
+            remaining_--;
+            if (skip_ > 0) {
+                skip_--;
+                continue;
+            }
+            row[c] = ' ';
+            onPunch(c);
+            if (--needed_ == 0) return;
+            skip_ = nextSkip();
+        }
+    }
+
+private:
+    // Number of candidates to pass over before the next pick
+    int64_t nextSkip() {
+        double v = randomUnit(rng_);
+        double top = static_cast<double>(remaining_ - needed_);
+        double n = static_cast<double>(remaining_);
+        double quot = top / n;
+        int64_t skip = 0;
+        while (quot > v) {
+            skip++;
+            top -= 1;
+            n -= 1;
+            quot *= top / n;
+        }
+        return skip;
+    }
+
+    int rows_;
+    Rng& rng_;
+    int64_t remaining_ = 0, needed_ = 0, skip_ = 0;
+};
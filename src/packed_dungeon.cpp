@@ -0,0 +1,230 @@
+/**
+ * Dungeon Pathfinder - Packed Dungeon Format
+ *
+ * Bit-plane encoding of dungeons, ASCII conversion and mapped loading.
+ */
+
+#include "packed_dungeon.h"
+#include "tiles.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+
+static bool isKey(char ch) {
+    return ch >= 'a' && ch <= 'z';
+}
+
+// Finds the tile at cell in a table sorted by cell
+static const PackedTile* findTile(const PackedTile* table, size_t count, uint32_t cell) {
+    const PackedTile* last = table + count;
+    const PackedTile* it = lower_bound(table, last, cell,
+        [](const PackedTile& tile, uint32_t c) { return tile.cell < c; });
+    return (it != last && it->cell == cell) ? it : nullptr;
+}
+
+vector<uint8_t> packDungeon(const Grid& dungeon, uint64_t seed) {
+    const int rows = dungeon.rows(), cols = dungeon.cols();
+    const uint32_t wordsPerRow = static_cast<uint32_t>((cols + 63) / 64);
+
+    PackedDungeonHeader header = {};
+    memcpy(header.magic, "DPKD", 4);
+    header.version = PACKED_DUNGEON_VERSION;
+    header.headerSize = sizeof(PackedDungeonHeader);
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.rows = rows;
+    header.cols = cols;
+    header.wordsPerRow = wordsPerRow;
+    header.seed = seed;
+    header.startRow = header.startCol = header.exitRow = header.exitCol = -1;
+
+    // Padding bits stay set so the plane reads as walls past the last column
+    vector<uint64_t> plane(static_cast<size_t>(rows) * wordsPerRow, ~uint64_t(0));
+    vector<PackedTile> keys, tiles;
+    for (int r = 0; r < rows; r++) {
+        const char* row = dungeon.data() + dungeon.index(r, 0);
+        uint64_t* words = plane.data() + static_cast<size_t>(r) * wordsPerRow;
+        for (int c = 0; c < cols; c++) {
+            char ch = row[c];
+            if (!blocksWithoutKeys(ch)) words[c / 64] &= ~(uint64_t(1) << (c % 64));
+            if (ch == '#' || ch == ' ') continue;
+
+            if (ch == 'S' && header.startRow < 0) {
+                header.startRow = r;
+                header.startCol = c;
+                continue;
+            }
+            if (ch == 'E' && header.exitRow < 0) {
+                header.exitRow = r;
+                header.exitCol = c;
+                continue;
+            }
+            PackedTile tile = {};
+            tile.cell = static_cast<uint32_t>(r) * cols + c;
+            tile.tile = ch;
+            (isKey(ch) ? keys : tiles).push_back(tile);
+        }
+    }
+    header.numKeys = static_cast<uint32_t>(keys.size());
+    header.numTiles = static_cast<uint32_t>(tiles.size());
+
+    size_t keyBytes = keys.size() * sizeof(PackedTile);
+    size_t planeBytes = plane.size() * sizeof(uint64_t);
+    size_t tileBytes = tiles.size() * sizeof(PackedTile);
+    vector<uint8_t> bytes(sizeof(header) + keyBytes + planeBytes + tileBytes);
+
+    uint8_t* out = bytes.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    if (keyBytes) memcpy(out, keys.data(), keyBytes);
+    out += keyBytes;
+    if (planeBytes) memcpy(out, plane.data(), planeBytes);
+    out += planeBytes;
+    if (tileBytes) memcpy(out, tiles.data(), tileBytes);
+    return bytes;
+}
+
+vector<uint8_t> packDungeon(const vector<string>& dungeon, uint64_t seed) {
+    return packDungeon(Grid::fromStrings(dungeon), seed);
+}
+
+bool savePackedDungeon(const string& path, const vector<string>& dungeon, uint64_t seed) {
+    vector<uint8_t> bytes = packDungeon(dungeon, seed);
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return fclose(file) == 0 && ok;
+}
+
+PackedDungeonView PackedDungeonView::fromBytes(const void* data, size_t size) {
+    PackedDungeonView view;
+    if (!data || size < sizeof(PackedDungeonHeader)) return view;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) return view;
+
+    const PackedDungeonHeader* header = static_cast<const PackedDungeonHeader*>(data);
+    if (memcmp(header->magic, "DPKD", 4) != 0) return view;
+    if (header->version != PACKED_DUNGEON_VERSION) return view;
+    if (header->headerSize != sizeof(PackedDungeonHeader)) return view;
+    if (header->byteOrder != BYTE_ORDER_MARK) return view;  // written on a host of other endianness
+    if (header->rows < 0 || header->cols < 0) return view;
+    if (header->wordsPerRow != static_cast<uint32_t>((header->cols + 63) / 64)) return view;
+
+    // Section sizes, checked against the buffer before anything is read
+    uint64_t keyBytes = uint64_t(header->numKeys) * sizeof(PackedTile);
+    uint64_t planeBytes = uint64_t(header->rows) * header->wordsPerRow * sizeof(uint64_t);
+    uint64_t tileBytes = uint64_t(header->numTiles) * sizeof(PackedTile);
+    if (sizeof(PackedDungeonHeader) + keyBytes + planeBytes + tileBytes > size) return view;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data) + sizeof(PackedDungeonHeader);
+    view.keys_ = reinterpret_cast<const PackedTile*>(bytes);
+    view.plane_ = reinterpret_cast<const uint64_t*>(bytes + keyBytes);
+    view.tiles_ = reinterpret_cast<const PackedTile*>(bytes + keyBytes + planeBytes);
+    view.header_ = header;
+    return view;
+}
+
+WallPlane PackedDungeonView::walls() const {
+    WallPlane plane;
+    plane.words = plane_;
+    plane.rows = header_->rows;
+    plane.cols = header_->cols;
+    plane.wordsPerRow = static_cast<int>(header_->wordsPerRow);
+    return plane;
+}
+
+char PackedDungeonView::at(int row, int col) const {
+    if (row == header_->startRow && col == header_->startCol) return 'S';
+    if (row == header_->exitRow && col == header_->exitCol) return 'E';
+
+    uint32_t cell = static_cast<uint32_t>(row) * header_->cols + col;
+    if (const PackedTile* key = findTile(keys_, header_->numKeys, cell)) return key->tile;
+    if (const PackedTile* tile = findTile(tiles_, header_->numTiles, cell)) return tile->tile;
+
+    uint64_t word = plane_[static_cast<size_t>(row) * header_->wordsPerRow + col / 64];
+    return (word >> (col % 64)) & 1 ? '#' : ' ';
+}
+
+Grid PackedDungeonView::toGrid() const {
+    const int rows = header_->rows, cols = header_->cols;
+    Grid dungeon(rows, cols, ' ');
+
+    // Walls from the plane, then the sparse tiles on top
+    for (int r = 0; r < rows; r++) {
+        const uint64_t* words = plane_ + static_cast<size_t>(r) * header_->wordsPerRow;
+        for (int c = 0; c < cols; c++) {
+            if ((words[c / 64] >> (c % 64)) & 1) dungeon.at(r, c) = '#';
+        }
+    }
+    auto place = [&](const PackedTile* table, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            int r = static_cast<int>(table[i].cell / cols), c = static_cast<int>(table[i].cell % cols);
+            if (r < rows) dungeon.at(r, c) = table[i].tile;
+        }
+    };
+    place(keys_, header_->numKeys);
+    place(tiles_, header_->numTiles);
+    if (dungeon.inBounds(header_->startRow, header_->startCol)) {
+        dungeon.at(header_->startRow, header_->startCol) = 'S';
+    }
+    if (dungeon.inBounds(header_->exitRow, header_->exitCol)) {
+        dungeon.at(header_->exitRow, header_->exitCol) = 'E';
+    }
+    return dungeon;
+}
+
+vector<string> PackedDungeonView::toStrings() const {
+    return toGrid().toStrings();
+}
+
+MappedDungeon::MappedDungeon(const string& path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data_ = mapping;
+            size_ = static_cast<size_t>(info.st_size);
+        }
+    }
+    close(fd);
+    if (data_) view_ = PackedDungeonView::fromBytes(data_, size_);
+#else
+    // No mmap: read the file into an 8-byte aligned buffer instead
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length > 0) {
+        buffer_.resize((static_cast<size_t>(length) + 7) / 8);
+        size_ = fread(buffer_.data(), 1, static_cast<size_t>(length), file);
+        view_ = PackedDungeonView::fromBytes(buffer_.data(), size_);
+    }
+    fclose(file);
+#endif
+}
+
+MappedDungeon::~MappedDungeon() {
+#ifndef _WIN32
+    if (data_) munmap(data_, size_);
+#endif
+}
+
+vector<Cell> bfsPathBitParallel(const PackedDungeonView& level) {
+    if (!level.valid() || level.start().r < 0 || level.exit().r < 0) return {};
+    return bfsPathBitParallel(level.walls(), level.start(), level.exit());
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "bitbfs.h"
+
+/**
+ * Packed on-disk dungeon format (little-endian, every section 8-byte aligned):
+ *
+ *   PackedDungeonHeader   64 bytes: size, seed, S/E and table counts
+ *   key table             numKeys PackedTiles, the 'a'-'z' keys
+ *   wall plane            rows * wordsPerRow uint64_t words in the WallPlane
+ *                         layout, bit set = blocked ('#' or a door 'A'-'F')
+ *   tile table            numTiles PackedTiles, every other non-wall, non-floor
+ *                         tile (doors and any custom characters)
+ *
+ * A cell costs one bit plus 8 bytes per special tile, against 8 bits per
+ * cell and a string per row for the ASCII form. The wall plane is exactly
+ * what bfsPathBitParallel reads, so a mapped file is solved in place.
+ * Both tables are sorted by cell, and S/E live only in the header.
+ */
+struct PackedDungeonHeader {
+    char magic[4];          // "DPKD"
+    uint16_t version;       // PACKED_DUNGEON_VERSION
+    uint16_t headerSize;    // sizeof(PackedDungeonHeader)
+    uint32_t byteOrder;     // 0x01020304 as written by the producer
+    int32_t rows, cols;
+    uint32_t wordsPerRow;   // (cols + 63) / 64
+    uint64_t seed;          // generator seed, 0 if unknown
+    int32_t startRow, startCol;  // -1 if the dungeon has no 'S'
+    int32_t exitRow, exitCol;    // -1 if the dungeon has no 'E'
+    uint32_t numKeys;
+    uint32_t numTiles;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(PackedDungeonHeader) == 64, "packed header layout changed");
+
+const uint16_t PACKED_DUNGEON_VERSION = 1;
+
+// One special tile: cell is r * cols + c
+struct PackedTile {
+    uint32_t cell;
+    char tile;
+    uint8_t padding[3];
+};
+
+/**
+ * Encodes a dungeon in the packed format.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @param seed Generator seed to record in the header (0 if unknown)
+ * @return The encoded bytes
+ */
+std::vector<uint8_t> packDungeon(const std::vector<std::string>& dungeon, uint64_t seed = 0);
+std::vector<uint8_t> packDungeon(const Grid& dungeon, uint64_t seed = 0);
+
+/**
+ * Writes packDungeon(dungeon, seed) to a file.
+ *
+ * @return false if the file could not be written
+ */
+bool savePackedDungeon(const std::string& path, const std::vector<std::string>& dungeon,
+                       uint64_t seed = 0);
+
+/**
+ * Read-only view of packed dungeon bytes. Nothing is copied: the view
+ * points into the buffer (or mapping) it was made from, which must outlive it.
+ */
+class PackedDungeonView {
+public:
+    PackedDungeonView() = default;
+
+    /**
+     * Checks the header and section sizes and builds a view over data.
+     *
+     * @param data Start of the encoded dungeon (8-byte aligned)
+     * @param size Number of bytes available
+     * @return A view; valid() is false if the bytes are not a packed dungeon
+     */
+    static PackedDungeonView fromBytes(const void* data, size_t size);
+
+    bool valid() const { return header_ != nullptr; }
+
+    int rows() const { return header_->rows; }
+    int cols() const { return header_->cols; }
+    uint64_t seed() const { return header_->seed; }
+    Cell start() const { return Cell(header_->startRow, header_->startCol); }
+    Cell exit() const { return Cell(header_->exitRow, header_->exitCol); }
+
+    const PackedTile* keys() const { return keys_; }
+    size_t numKeys() const { return header_->numKeys; }
+    const PackedTile* tiles() const { return tiles_; }
+    size_t numTiles() const { return header_->numTiles; }
+
+    // Blocked cells in the layout bfsPathBitParallel takes
+    WallPlane walls() const;
+
+    /**
+     * Decodes one tile (binary search in the side tables).
+     *
+     * @return The ASCII character at (row, col)
+     */
+    char at(int row, int col) const;
+
+    // Conversion back to the ASCII forms used by generateDungeon and the solvers
+    Grid toGrid() const;
+    std::vector<std::string> toStrings() const;
+
+private:
+    const PackedDungeonHeader* header_ = nullptr;
+    const PackedTile* keys_ = nullptr;
+    const uint64_t* plane_ = nullptr;
+    const PackedTile* tiles_ = nullptr;
+};
+
+/**
+ * A packed dungeon file mapped into memory (mmap on POSIX; read into a
+ * buffer elsewhere). view() reads the mapping directly.
+ */
+class MappedDungeon {
+public:
+    explicit MappedDungeon(const std::string& path);
+    ~MappedDungeon();
+
+    MappedDungeon(const MappedDungeon&) = delete;
+    MappedDungeon& operator=(const MappedDungeon&) = delete;
+
+    // false if the file could not be opened or is not a packed dungeon
+    bool ok() const { return view_.valid(); }
+    const PackedDungeonView& view() const { return view_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<uint64_t> buffer_;  // used when mmap is not available
+    PackedDungeonView view_;
+};
+
+/**
+ * Solves a packed dungeon straight from its wall plane with the
+ * bit-parallel BFS (doors block, as in bfsPath).
+ *
+ * @param level View of a packed dungeon
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathBitParallel(const PackedDungeonView& level);
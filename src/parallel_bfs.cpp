@@ -0,0 +1,238 @@
+/**
+ * Dungeon Pathfinder - Parallel BFS
+ *
+ * Level-synchronous BFS with the frontier split across a thread pool.
+ */
+
+#include "parallel_bfs.h"
+#include "solver.h"
+#include "solver_stats.h"
+#include "dense.h"
+#include "tiles.h"
+#include "level_index.h"
+#include "keygraph.h"
+#include "thread_pool.h"
+#include <vector>
+#include <string>
+#include <atomic>
+#include <algorithm>
+
+using namespace std;
+
+// Layers with fewer frontier entries than this are expanded on the calling
+// thread; handing them to the pool costs more than it saves
+static const size_t PARALLEL_MIN_FRONTIER = 2048;
+static const size_t PARALLEL_CHUNK = 512;
+
+// Picked-up-key flag in a key-state parent record (as in bfsPathKeys)
+static const uint8_t PICKED_KEY = 4;
+
+// Expands one layer, in parallel when it is big enough, then merges the
+// thread-local outputs into the next frontier
+template <typename Id, typename Expand>
+static void expandLayer(ThreadPool& pool, vector<Id>& frontier,
+                        vector<vector<Id>>& local, Expand expand) {
+    if (frontier.size() < PARALLEL_MIN_FRONTIER) {
+        expand(0, frontier.size(), local[0]);
+    } else {
+        pool.parallelFor(frontier.size(), PARALLEL_CHUNK, [&](size_t begin, size_t end, int worker) {
+            expand(begin, end, local[worker]);
+        });
+    }
+    frontier.clear();
+    for (vector<Id>& out : local) {
+        frontier.insert(frontier.end(), out.begin(), out.end());
+        out.clear();
+    }
+}
+
+// Bytes held by the thread-local output buffers
+template <typename Id>
+static uint64_t localBytes(const vector<vector<Id>>& local) {
+    uint64_t bytes = capacityBytes(local);
+    for (const vector<Id>& out : local) bytes += capacityBytes(out);
+    return bytes;
+}
+
+// Counters are added once per layer, on the calling thread, so the workers
+// never touch the stats
+template <typename Stats>
+static vector<Cell> parallelSearch(const Grid& dungeon, int threads, Stats& stats) {
+    int startIdx = dungeon.find('S');
+    int goalIdx = dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+
+    // One byte per parent direction (not packed) so threads claiming
+    // neighboring cells never write the same byte
+    AtomicBitSet visited(dungeon.size());
+    vector<uint8_t> parentDir(dungeon.size());
+    atomic<bool> found(false);
+
+    ThreadPool pool(threads);
+    vector<vector<int>> local(threads);
+    vector<int> frontier{startIdx};
+    visited.testAndSet(startIdx);
+    stats.layers(1);
+    stats.push();
+    stats.visit(0);
+
+    int depth = 0;  // layers expanded so far; E sits in the last one
+    while (!frontier.empty() && !found) {
+        depth++;
+        stats.pop(frontier.size());
+        expandLayer(pool, frontier, local, [&](size_t begin, size_t end, vector<int>& out) {
+            for (size_t i = begin; i < end; i++) {
+                int cur = frontier[i];
+                for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                    int n = cur + dungeon.offset(d);
+                    char ch = dungeon[n];
+                    if (blocksWithoutKeys(ch)) continue;
+                    if (visited.testAndSet(n)) continue;
+                    parentDir[n] = static_cast<uint8_t>(d);
+                    if (n == goalIdx) found = true;
+                    out.push_back(n);
+                }
+            }
+        });
+        stats.push(frontier.size());
+        stats.visit(0, frontier.size());
+        stats.frontier(frontier.size());
+    }
+    stats.allocated(visited.bytes() + capacityBytes(parentDir) + capacityBytes(frontier) + localBytes(local));
+    if (!found) return {};
+    stats.phase(SolvePhase::Reconstruct);
+
+    // Sized from the depth and filled back to front
+    vector<Cell> path(depth + 1);
+    int cur = goalIdx;
+    for (int i = depth; i > 0; i--) {
+        path[i] = dungeon.cellAt(cur);
+        cur -= dungeon.offset(parentDir[cur]);
+    }
+    path[0] = dungeon.cellAt(startIdx);
+    return path;
+}
+
+vector<Cell> bfsPathParallel(const Grid& dungeon, int threads) {
+    if (threads <= 0) threads = solverThreads();
+    if (threads == 1 || dungeon.size() < PARALLEL_MIN_CELLS) return bfsPath(dungeon);
+    NoStats stats;
+    return parallelSearch(dungeon, threads, stats);
+}
+
+vector<Cell> bfsPathParallel(const Grid& dungeon, SolverStats& stats, int threads) {
+    if (threads <= 0) threads = solverThreads();
+    if (threads == 1 || dungeon.size() < PARALLEL_MIN_CELLS) return bfsPath(dungeon, stats);
+    StatsRecorder recorder(stats);
+    return parallelSearch(dungeon, threads, recorder);
+}
+
+vector<Cell> bfsPathParallel(const vector<string>& dungeon, int threads) {
+    return bfsPathParallel(Grid::fromStrings(dungeon), threads);
+}
+
+template <typename Stats>
+static vector<Cell> parallelSearchKeys(const Grid& dungeon, int threads, Stats& stats) {
+    LevelIndex level = indexLevel(dungeon);
+    int startIdx = level.start;
+    int goalIdx = level.goal;
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+
+    TileMap tiles(dungeon, level, DEFAULT_NUM_KEYS);
+    if (keyGraphIsCheaper(tiles)) {
+        stats.usedKeyGraph();
+        return keyGraphPath(dungeon, level, tiles);
+    }
+
+    // State id = keys * cells + cell index, as in bfsPathKeys
+    const uint64_t cells = static_cast<uint64_t>(dungeon.size());
+    AtomicBitSet visited(cells * tiles.numLayers());
+    vector<uint8_t> parent(cells * tiles.numLayers());
+    atomic<uint64_t> goalState(0);
+    const uint64_t NOT_FOUND = 0;  // state 0 is a wall-border tile, never reached
+
+    ThreadPool pool(threads);
+    vector<vector<uint64_t>> local(threads);
+    vector<uint64_t> frontier{static_cast<uint64_t>(startIdx)};
+    visited.testAndSet(startIdx);
+    stats.layers(tiles.numLayers());
+    stats.push();
+    stats.visit(0);
+
+    int depth = 0;
+    while (!frontier.empty() && goalState == NOT_FOUND) {
+        depth++;
+        stats.pop(frontier.size());
+        expandLayer(pool, frontier, local, [&](size_t begin, size_t end, vector<uint64_t>& out) {
+            for (size_t i = begin; i < end; i++) {
+                uint64_t keys = frontier[i] / cells;
+                int curIdx = static_cast<int>(frontier[i] % cells);
+                for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                    int nextIdx = curIdx + dungeon.offset(d);
+                    uint8_t tile = tiles[nextIdx];
+                    if (tile == TILE_WALL) continue;
+
+                    uint64_t newKeys = keys;
+                    uint8_t record = static_cast<uint8_t>(d);
+                    if (tile & TILE_DOOR) {
+                        if (!((newKeys >> (tile & TILE_BIT_MASK)) & 1)) continue; // door locked
+                    } else if (tile & TILE_KEY) {
+                        uint64_t bit = uint64_t(1) << (tile & TILE_BIT_MASK);
+                        if (!(newKeys & bit)) record |= PICKED_KEY;
+                        newKeys |= bit;
+                    }
+
+                    uint64_t next = newKeys * cells + nextIdx;
+                    if (visited.testAndSet(next)) continue;
+                    parent[next] = record;
+                    if (nextIdx == goalIdx) {
+                        uint64_t expected = NOT_FOUND;
+                        goalState.compare_exchange_strong(expected, next);
+                    }
+                    out.push_back(next);
+                }
+            }
+        });
+        stats.push(frontier.size());
+        stats.frontier(frontier.size());
+        if constexpr (Stats::enabled) {
+            for (uint64_t state : frontier) stats.visit(state / cells);
+        }
+    }
+    stats.allocated(visited.bytes() + capacityBytes(parent) + capacityBytes(frontier) + localBytes(local));
+    if (goalState == NOT_FOUND) return {};
+    stats.phase(SolvePhase::Reconstruct);
+
+    vector<Cell> path(depth + 1);
+    uint64_t s = goalState;
+    for (int step = depth; step > 0; step--) {
+        int sIdx = static_cast<int>(s % cells);
+        uint64_t sKeys = s / cells;
+        uint8_t rec = parent[s];
+        path[step] = dungeon.cellAt(sIdx);
+        if (rec & PICKED_KEY) sKeys ^= uint64_t(1) << (tiles[sIdx] & TILE_BIT_MASK);
+        s = sKeys * cells + (sIdx - dungeon.offset(rec & 3));
+    }
+    path[0] = dungeon.cellAt(startIdx);
+    return path;
+}
+
+vector<Cell> bfsPathKeysParallel(const Grid& dungeon, int threads) {
+    if (threads <= 0) threads = solverThreads();
+    if (threads == 1 || dungeon.size() < PARALLEL_MIN_CELLS) return bfsPathKeys(dungeon);
+    NoStats stats;
+    return parallelSearchKeys(dungeon, threads, stats);
+}
+
+vector<Cell> bfsPathKeysParallel(const Grid& dungeon, SolverStats& stats, int threads) {
+    if (threads <= 0) threads = solverThreads();
+    if (threads == 1 || dungeon.size() < PARALLEL_MIN_CELLS) return bfsPathKeys(dungeon, stats);
+    StatsRecorder recorder(stats);
+    return parallelSearchKeys(dungeon, threads, recorder);
+}
+
+vector<Cell> bfsPathKeysParallel(const vector<string>& dungeon, int threads) {
+    return bfsPathKeysParallel(Grid::fromStrings(dungeon), threads);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "cell.h"
+#include "grid.h"
+#include "solver_stats.h"
+
+// Grids smaller than this (buffer cells) are always solved serially: thread
+// start-up and per-layer synchronization would cost more than the search
+const int PARALLEL_MIN_CELLS = 1 << 16;
+
+/**
+ * Multi-threaded level-synchronous BFS. Each layer's frontier is split
+ * across a thread pool; threads claim cells with an atomic test-and-set on
+ * a shared visited bitset and collect the next frontier in thread-local
+ * buffers that are merged after the layer. Returns the same shortest path
+ * length as bfsPath. Small grids fall back to the serial bfsPath.
+ * The SolverStats overload also records the search (see solver_stats.h),
+ * adding the counters once per layer after the merge.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @param threads Worker threads to use (0 = solverThreads())
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathParallel(const std::vector<std::string>& dungeon, int threads = 0);
+std::vector<Cell> bfsPathParallel(const Grid& dungeon, int threads = 0);
+std::vector<Cell> bfsPathParallel(const Grid& dungeon, SolverStats& stats, int threads = 0);
+
+/**
+ * Multi-threaded version of bfsPathKeys (default 'a'-'f' alphabet). The
+ * frontier holds states from every key layer, so the work is split across
+ * key layers as well as across cells. Small grids, and maps where the
+ * key-graph solver is cheaper, use the serial bfsPathKeys. The SolverStats
+ * overload records as bfsPathParallel does.
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @param threads Worker threads to use (0 = solverThreads())
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathKeysParallel(const std::vector<std::string>& dungeon, int threads = 0);
+std::vector<Cell> bfsPathKeysParallel(const Grid& dungeon, int threads = 0);
+std::vector<Cell> bfsPathKeysParallel(const Grid& dungeon, SolverStats& stats, int threads = 0);
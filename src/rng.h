@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+/**
+ * SplitMix64: tiny 64-bit generator, used to expand one seed into the
+ * state of the other generators (and to derive independent stream seeds).
+ */
+class SplitMix64 {
+public:
+    typedef uint64_t result_type;
+
+    explicit SplitMix64(uint64_t seed) : state_(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state_;
+};
+
+/**
+ * xoshiro256**: fast general-purpose generator with 32 bytes of state
+ * (versus about 5KB for mt19937), so it is cheap to construct per level.
+ * Satisfies UniformRandomBitGenerator, so it works with std::shuffle.
+ */
+class Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    explicit Xoshiro256(uint64_t seed) {
+        SplitMix64 init(seed);
+        for (uint64_t& word : s_) word = init();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+/**
+ * Uniform integer in [0, bound) without modulo bias (Lemire's multiply-shift
+ * method; it only divides on the rare rejection path). Works with any
+ * generator producing at least 32 random bits per call.
+ *
+ * @param rng Random bit generator
+ * @param bound Exclusive upper bound (must be > 0)
+ * @return Uniformly distributed value below bound
+ */
+template <typename Rng>
+uint32_t randomBelow(Rng& rng, uint32_t bound) {
+    auto next32 = [&rng]() -> uint32_t {
+        // Prefer the high bits of 64-bit generators, they are the strongest
+        return Rng::max() > 0xFFFFFFFFull ? static_cast<uint32_t>(rng() >> 32)
+                                          : static_cast<uint32_t>(rng());
+    };
+    uint64_t m = static_cast<uint64_t>(next32()) * bound;
+    uint32_t low = static_cast<uint32_t>(m);
+    if (low < bound) {
+        uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+        while (low < threshold) {
+            m = static_cast<uint64_t>(next32()) * bound;
+            low = static_cast<uint32_t>(m);
+        }
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
+
+/**
+ * Uniform double in [0, 1) with 53 random bits (two draws for 32-bit
+ * generators), computed identically on every platform.
+ *
+ * @param rng Random bit generator
+ * @return Uniformly distributed value in [0, 1)
+ */
+template <typename Rng>
+double randomUnit(Rng& rng) {
+    uint64_t bits;
+    if (Rng::max() > 0xFFFFFFFFull) {
+        bits = static_cast<uint64_t>(rng()) >> 11;
+    } else {
+        uint64_t high = static_cast<uint32_t>(rng()) >> 5;  // 27 bits
+        uint64_t low = static_cast<uint32_t>(rng()) >> 6;   // 26 bits
+        bits = (high << 26) | low;
+    }
+    return static_cast<double>(bits) * (1.0 / 9007199254740992.0);  // 2^-53
+}
@@ -0,0 +1,250 @@
+/**
+ * Dungeon Pathfinder - Solve Service
+ *
+ * Asynchronous, batched and cached solving for many concurrent callers.
+ */
+
+#include "solve_service.h"
+#include "distance_field.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <exception>
+#include <unordered_set>
+
+using namespace std;
+
+SolveService::SolveService(int threads, size_t cacheCapacity)
+    : cacheCapacity_(cacheCapacity), pool_(threads <= 0 ? solverThreads() : threads) {
+    latencies_.reserve(LATENCY_WINDOW);
+    for (int w = 0; w < pool_.size(); w++) pool_.submit([this] { workerLoop(); });
+}
+
+SolveService::~SolveService() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    batchReady_.notify_all();
+    pool_.wait();
+}
+
+future<vector<Cell>> SolveService::submit(const Grid& dungeon, SolveRules rules) {
+    return enqueue(dungeon, dungeonId(dungeon), exitGoal(), rules);
+}
+
+future<vector<Cell>> SolveService::submit(const vector<string>& dungeon, SolveRules rules) {
+    return submit(Grid::fromStrings(dungeon), rules);
+}
+
+future<vector<Cell>> SolveService::submit(const Grid& dungeon, Cell goal, SolveRules rules) {
+    return enqueue(dungeon, dungeonId(dungeon), goal, rules);
+}
+
+future<vector<Cell>> SolveService::enqueue(const Grid& dungeon, uint64_t id, Cell goal,
+                                           SolveRules rules) {
+    const Clock::time_point submitted = Clock::now();
+    const MapKey mapKey{id, rules};
+    Request request{goal, promise<vector<Cell>>(), submitted};
+    future<vector<Cell>> result = request.result.get_future();
+
+    unique_lock<mutex> lock(mutex_);
+    counters_.submitted++;
+    if (const vector<Cell>* path = cached(PathKey{mapKey, goal})) {
+        counters_.cacheHits++;
+        finish(request, *path, Clock::now());
+        return result;
+    }
+
+    // Copy the map outside the lock, only when no batch for it exists yet
+    shared_ptr<const Grid> copy;
+    if (batches_.find(mapKey) == batches_.end()) {
+        lock.unlock();
+        copy = make_shared<const Grid>(dungeon);
+        lock.lock();
+        // A worker may have finished this map meanwhile
+        if (const vector<Cell>* path = cached(PathKey{mapKey, goal})) {
+            counters_.cacheHits++;
+            finish(request, *path, Clock::now());
+            return result;
+        }
+    }
+
+    auto it = batches_.find(mapKey);
+    if (it == batches_.end()) {
+        Batch& batch = batches_[mapKey];
+        batch.dungeon = move(copy);
+        batch.requests.push_back(move(request));
+        queue_.push_back(mapKey);
+        lock.unlock();
+        batchReady_.notify_one();
+    } else {
+        counters_.joined++;
+        Batch& batch = it->second;
+        (batch.running ? batch.late : batch.requests).push_back(move(request));
+    }
+    return result;
+}
+
+void SolveService::workerLoop() {
+    // Per-worker workspace, reused across every batch this worker solves
+    Solver solver;
+    vector<pair<Cell, vector<Cell>>> paths;
+
+    unique_lock<mutex> lock(mutex_);
+    for (;;) {
+        batchReady_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return;  // stopping and drained
+
+        const MapKey key = queue_.front();
+        queue_.pop_front();
+        // References into an unordered_map survive rehashing
+        Batch& batch = batches_.find(key)->second;
+        batch.running = true;
+        vector<Request> requests = move(batch.requests);
+        batch.requests.clear();
+        shared_ptr<const Grid> dungeon = batch.dungeon;
+        counters_.batches++;
+        lock.unlock();
+
+        exception_ptr error;
+        try {
+            solveBatch(solver, *dungeon, key.rules, requests, paths);
+        } catch (...) {
+            error = current_exception();
+        }
+
+        lock.lock();
+        auto pathFor = [&paths](Cell goal) -> const vector<Cell>* {
+            for (const auto& entry : paths) {
+                if (entry.first == goal) return &entry.second;
+            }
+            return nullptr;
+        };
+        const Clock::time_point now = Clock::now();
+        if (error) {
+            for (Request& request : requests) request.result.set_exception(error);
+            for (Request& request : batch.late) request.result.set_exception(error);
+            batch.late.clear();
+        } else {
+            counters_.solvedPaths += paths.size();
+            for (const auto& entry : paths) store(PathKey{key, entry.first}, entry.second);
+            for (Request& request : requests) finish(request, *pathFor(request.goal), now);
+        }
+
+        // Requests that came in during the search: answer those it covered,
+        // queue the rest as the map's next batch
+        for (Request& request : batch.late) {
+            const vector<Cell>* path = pathFor(request.goal);
+            if (!path) path = cached(PathKey{key, request.goal});
+            if (path) {
+                finish(request, *path, now);
+            } else {
+                batch.requests.push_back(move(request));
+            }
+        }
+        batch.late.clear();
+        batch.running = false;
+        if (batch.requests.empty()) {
+            batches_.erase(key);
+        } else {
+            queue_.push_back(key);
+            batchReady_.notify_one();
+        }
+    }
+}
+
+void SolveService::solveBatch(Solver& solver, const Grid& dungeon, SolveRules rules,
+                              const vector<Request>& requests,
+                              vector<pair<Cell, vector<Cell>>>& paths) {
+    paths.clear();
+    unordered_set<Cell, CellHash> goals;
+    for (const Request& request : requests) {
+        if (goals.insert(request.goal).second) paths.emplace_back(request.goal, vector<Cell>());
+    }
+
+    // Only S to E: the workspace solver, with no per-call allocation
+    if (paths.size() == 1 && paths[0].first == exitGoal()) {
+        paths[0].second = solver.solve(dungeon, rules);
+        return;
+    }
+
+    // Several goals: one distance field from S answers all of them
+    int startIdx = dungeon.find('S');
+    if (startIdx == -1) return;
+    DistanceField field(dungeon, dungeon.cellAt(startIdx), rules);
+    for (auto& entry : paths) {
+        Cell target = entry.first;
+        if (target == exitGoal()) {
+            int goalIdx = dungeon.find('E');
+            if (goalIdx == -1) continue;
+            target = dungeon.cellAt(goalIdx);
+        }
+        entry.second = field.pathTo(target);
+    }
+}
+
+const vector<Cell>* SolveService::cached(const PathKey& key) {
+    auto it = cache_.find(key);
+    if (it == cache_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->second;
+}
+
+void SolveService::store(const PathKey& key, const vector<Cell>& path) {
+    if (cacheCapacity_ == 0) return;
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    if (cache_.size() >= cacheCapacity_) {
+        cache_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    lru_.emplace_front(key, path);
+    cache_[key] = lru_.begin();
+}
+
+void SolveService::finish(Request& request, const vector<Cell>& path, Clock::time_point now) {
+    request.result.set_value(path);
+    double seconds = chrono::duration<double>(now - request.submitted).count();
+    if (latencies_.size() < LATENCY_WINDOW) {
+        latencies_.push_back(seconds);
+    } else {
+        latencies_[nextLatency_] = seconds;
+    }
+    nextLatency_ = (nextLatency_ + 1) % LATENCY_WINDOW;
+}
+
+SolveServiceStats SolveService::stats() const {
+    vector<double> samples;
+    SolveServiceStats stats;
+    {
+        lock_guard<mutex> lock(mutex_);
+        stats = counters_;
+        samples = latencies_;
+    }
+    auto percentile = [&samples](double p) {
+        size_t rank = min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        nth_element(samples.begin(), samples.begin() + rank, samples.end());
+        return samples[rank];
+    };
+    if (!samples.empty()) {
+        stats.p50Seconds = percentile(0.50);
+        stats.p99Seconds = percentile(0.99);
+    }
+    return stats;
+}
+
+size_t SolveService::KeyHash::operator()(const MapKey& key) const {
+    uint64_t h = key.dungeon ^ (static_cast<uint64_t>(key.rules) * 0x9E3779B97F4A7C15ull);
+    return hash<uint64_t>()(h ^ (h >> 29));
+}
+
+size_t SolveService::KeyHash::operator()(const PathKey& key) const {
+    uint64_t h = (*this)(key.map);
+    h ^= (static_cast<uint64_t>(static_cast<uint32_t>(key.goal.r)) << 32 |
+          static_cast<uint32_t>(key.goal.c)) * 0x9E3779B97F4A7C15ull;
+    return hash<uint64_t>()(h ^ (h >> 29));
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <deque>
+#include <list>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "cell.h"
+#include "grid.h"
+#include "solver.h"
+#include "batch_solver.h"
+#include "thread_pool.h"
+
+/**
+ * Counters of a SolveService, taken by SolveService::stats(). Latencies
+ * run from submit() to the result being ready, over the most recent
+ * LATENCY_WINDOW requests (cache hits included).
+ */
+struct SolveServiceStats {
+    uint64_t submitted = 0;   // requests accepted
+    uint64_t cacheHits = 0;   // answered from the result cache at submit()
+    uint64_t batches = 0;     // batches solved, one per map per worker pickup
+    uint64_t solvedPaths = 0; // distinct (map, goal) paths searched for
+    uint64_t joined = 0;      // requests that joined a batch queued or running for their map
+    double p50Seconds = 0;
+    double p99Seconds = 0;
+};
+
+/**
+ * Asynchronous front end over the solvers for callers that send many
+ * concurrent requests, often for the same dungeons.
+ *
+ * submit() returns a future at once. Requests are grouped by map: a
+ * request for a map that already has a batch waiting (or being solved)
+ * joins it instead of queueing a search of its own. A worker takes one
+ * batch at a time; a batch asking only for S to E is solved with the
+ * worker's own Solver workspace, and a batch with several goals with one
+ * DistanceField from S shared by all of them.
+ *
+ * Finished paths go to an LRU cache keyed by the content hash of the
+ * dungeon (dungeonId), the rules and the goal, so a level that was solved
+ * once is answered at submit() from then on. As with DistanceFieldCache,
+ * equal hashes are taken to mean equal maps.
+ *
+ * Paths are shortest paths under bfsPath / bfsPathKeys rules (same length
+ * as theirs; where several exist, not necessarily the same cells).
+ */
+class SolveService {
+public:
+    /**
+     * Starts the workers.
+     *
+     * @param threads Worker threads (0 = solverThreads())
+     * @param cacheCapacity Paths kept in the result cache (0 disables it)
+     */
+    explicit SolveService(int threads = 0, size_t cacheCapacity = 1024);
+
+    // Solves every request still queued, then stops the workers
+    ~SolveService();
+
+    SolveService(const SolveService&) = delete;
+    SolveService& operator=(const SolveService&) = delete;
+
+    /**
+     * Queues a solve from S to E.
+     *
+     * @param dungeon The dungeon, copied only when it has to be searched
+     * @param rules Movement rules
+     * @return Path from S to E, or empty vector if no path exists
+     */
+    std::future<std::vector<Cell>> submit(const Grid& dungeon, SolveRules rules = SolveRules::Basic);
+    std::future<std::vector<Cell>> submit(const std::vector<std::string>& dungeon,
+                                          SolveRules rules = SolveRules::Basic);
+
+    /**
+     * Queues a solve from S to any cell.
+     *
+     * @param dungeon The dungeon, copied only when it has to be searched
+     * @param goal Target cell
+     * @param rules Movement rules
+     * @return Path from S to goal, or empty vector if unreachable
+     */
+    std::future<std::vector<Cell>> submit(const Grid& dungeon, Cell goal,
+                                          SolveRules rules = SolveRules::Basic);
+
+    int threads() const { return pool_.size(); }
+    SolveServiceStats stats() const;
+
+    // Latency samples kept for the percentiles
+    static const size_t LATENCY_WINDOW = 4096;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Goal of an S to E request
+    static Cell exitGoal() { return Cell(-1, -1); }
+
+    struct MapKey {
+        uint64_t dungeon;
+        SolveRules rules;
+        bool operator==(const MapKey& other) const {
+            return dungeon == other.dungeon && rules == other.rules;
+        }
+    };
+    struct PathKey {
+        MapKey map;
+        Cell goal;
+        bool operator==(const PathKey& other) const { return map == other.map && goal == other.goal; }
+    };
+    struct KeyHash {
+        size_t operator()(const MapKey& key) const;
+        size_t operator()(const PathKey& key) const;
+    };
+
+    struct Request {
+        Cell goal;
+        std::promise<std::vector<Cell>> result;
+        Clock::time_point submitted;
+    };
+
+    // Requests for one map: queued until a worker takes them, and those
+    // that arrive while it solves, which it answers before leaving
+    struct Batch {
+        std::shared_ptr<const Grid> dungeon;
+        std::vector<Request> requests;
+        std::vector<Request> late;
+        bool running = false;
+    };
+
+    using CacheList = std::list<std::pair<PathKey, std::vector<Cell>>>;
+
+    std::future<std::vector<Cell>> enqueue(const Grid& dungeon, uint64_t id, Cell goal, SolveRules rules);
+    void workerLoop();
+
+    // Solves every goal of requests into paths, one entry per distinct goal
+    void solveBatch(Solver& solver, const Grid& dungeon, SolveRules rules,
+                    const std::vector<Request>& requests,
+                    std::vector<std::pair<Cell, std::vector<Cell>>>& paths);
+
+    // Cache lookup and insertion; the caller holds mutex_
+    const std::vector<Cell>* cached(const PathKey& key);
+    void store(const PathKey& key, const std::vector<Cell>& path);
+
+    // Sets the promise and records its latency; the caller holds mutex_
+    void finish(Request& request, const std::vector<Cell>& path, Clock::time_point now);
+
+    mutable std::mutex mutex_;
+    std::condition_variable batchReady_;
+    std::unordered_map<MapKey, Batch, KeyHash> batches_;
+    std::deque<MapKey> queue_;  // maps with a batch waiting, oldest first
+    bool stopping_ = false;
+
+    size_t cacheCapacity_;
+    CacheList lru_;  // most recently used first
+    std::unordered_map<PathKey, CacheList::iterator, KeyHash> cache_;
+
+    SolveServiceStats counters_;
+    std::vector<double> latencies_;  // ring of the last LATENCY_WINDOW samples
+    size_t nextLatency_ = 0;
+
+    ThreadPool pool_;  // last member: its workers use everything above
+};
@@ -7,186 +7,510 @@
 
 #include "solver.h"
 #include "cell.h"
+#include "grid.h"
+#include "dense.h"
+#include "tiles.h"
+#include "level_index.h"
+#include "grid_layout.h"
+#include "bfs_kernel.h"
+#include "keygraph.h"
+#include "bitbfs.h"
+#include "astar.h"
+#include "parallel_bfs.h"
+#include "solver_stats.h"
 #include <vector>
 #include <algorithm>
 #include <string>
-#include <queue>
-#include <unordered_map>
-#include <unordered_set>
+#include <memory_resource>
 
 using namespace std;
 
 // Find the position of a specific character in the dungeon
+Cell findPosition(const Grid& dungeon, char target) {
+    int idx = dungeon.find(target);
+    return idx == -1 ? Cell(-1, -1) : dungeon.cellAt(idx);
+}
+
 Cell findPosition(const vector<string>& dungeon, char target) {
     for (size_t row = 0; row < dungeon.size(); row++) {
-        for (size_t col = 0; col < dungeon[row].size(); col++) {
-            if (dungeon[row][col] == target) {
-                return Cell(static_cast<int>(row), static_cast<int>(col));
-            }
+        size_t col = dungeon[row].find(target);
+        if (col != string::npos) {
+            return Cell(static_cast<int>(row), static_cast<int>(col));
         }
     }
     return Cell(-1, -1);
 }
 
 // Check if the position is in bounds and not a wall
-static bool isValidCell(const vector<string>& dungeon, int row, int col) {
+bool isPassable(const Grid& dungeon, int row, int col) {
+    return dungeon.inBounds(row, col) && dungeon.at(row, col) != '#';
+}
+
+bool isPassable(const vector<string>& dungeon, int row, int col) {
     return row >= 0 && static_cast<size_t>(row) < dungeon.size() &&
-           col >= 0 && static_cast<size_t>(col) < dungeon[0].size() &&
+           col >= 0 && static_cast<size_t>(col) < dungeon[row].size() &&
            dungeon[row][col] != '#';
 }
 
-// Reconstruct a path from parent map
-static vector<Cell> reconstructPath(const unordered_map<Cell, Cell, CellHash>& parents,
-                                    const Cell& start, const Cell& goal) {
+
+// The BFS of bfsPath over one memory layout (RowMajorLayout or TiledGrid,
+// see grid_layout.h); startIdx and goalIdx are layout indices
+template <typename Moves, typename Layout, typename Path, typename Stats>
+static void searchLayout(const Layout& tiles, int startIdx, int goalIdx, pmr::memory_resource* resource,
+                         Path& path, Stats& stats) {
+    stats.phase(SolvePhase::Search);
+    DoorBlockRule<Layout> rule(tiles);
+    BfsKernel<Moves, DoorBlockRule<Layout>, Layout> bfs(tiles, rule, resource);
+    int depth = bfs.run(startIdx, stats, [goalIdx](int cell, uint8_t) { return cell == goalIdx; });
+    if (depth < 0) return;
+    stats.phase(SolvePhase::Reconstruct);
+    bfs.path(depth, path);
+}
+
+// bfsPath with every temporary allocated from resource, reporting to a
+// stats policy (NoStats or StatsRecorder, see solver_stats.h). Without a
+// level index, S and E are found with two memchr scans that stop at their
+// first hit, which is cheaper than indexing the whole level. Large grids
+// are copied into the tiled layout first (still the FindEndpoints phase).
+template <typename Moves = FourConnected, typename Path, typename Stats>
+static void searchPath(const Grid& dungeon, const LevelIndex* level, pmr::memory_resource* resource,
+                       Path& path, Stats& stats, GridLayout layout = GridLayout::Auto) {
+    int startIdx = level ? level->start : dungeon.find('S');
+    int goalIdx = level ? level->goal : dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return;
+
+    if (chooseLayout(dungeon, layout) == GridLayout::Tiled) {
+        TiledGrid tiles(dungeon, resource);
+        searchLayout<Moves>(tiles, tiles.fromGrid(startIdx), tiles.fromGrid(goalIdx), resource, path, stats);
+        return;
+    }
+    searchLayout<Moves>(RowMajorLayout(dungeon), startIdx, goalIdx, resource, path, stats);
+}
+
+vector<Cell> bfsPath(const Grid& dungeon) {
+    vector<Cell> path;
+    NoStats stats;
+    searchPath(dungeon, nullptr, pmr::get_default_resource(), path, stats);
+    return path;
+}
+
+vector<Cell> bfsPath(const Grid& dungeon, GridLayout layout) {
+    vector<Cell> path;
+    NoStats stats;
+    searchPath(dungeon, nullptr, pmr::get_default_resource(), path, stats, layout);
+    return path;
+}
+
+vector<Cell> bfsPath(const Grid& dungeon, Connectivity moves) {
     vector<Cell> path;
-    Cell current = goal;
-    while (!(current == start)) {
-        path.push_back(current);
-        current = parents.at(current);
+    NoStats stats;
+    if (moves == Connectivity::Eight) {
+        searchPath<EightConnected>(dungeon, nullptr, pmr::get_default_resource(), path, stats);
+    } else {
+        searchPath(dungeon, nullptr, pmr::get_default_resource(), path, stats);
     }
-    path.push_back(start);
-    reverse(path.begin(), path.end());
+    return path;
+}
+
+vector<Cell> bfsPath(const Grid& dungeon, const LevelIndex& level) {
+    vector<Cell> path;
+    NoStats stats;
+    searchPath(dungeon, &level, pmr::get_default_resource(), path, stats);
+    return path;
+}
+
+vector<Cell> bfsPath(const Grid& dungeon, SolverStats& stats) {
+    vector<Cell> path;
+    CountingResource counting(pmr::get_default_resource());
+    {
+        StatsRecorder recorder(stats);
+        searchPath(dungeon, nullptr, &counting, path, recorder);
+    }
+    stats.bytesAllocated = counting.bytes();
     return path;
 }
 
 vector<Cell> bfsPath(const vector<string>& dungeon) {
-    Cell start = findPosition(dungeon, 'S');
-    Cell goal = findPosition(dungeon, 'E');
-    if (start.r == -1 || goal.r == -1) return {};
+    return bfsPath(Grid::fromStrings(dungeon));
+}
 
-    queue<Cell> q;
-    unordered_map<Cell, Cell, CellHash> parents;
-    unordered_set<Cell, CellHash> visited;
+pmr::vector<Cell> bfsPath(const Grid& dungeon, pmr::memory_resource* resource) {
+    pmr::vector<Cell> path(resource);
+    NoStats stats;
+    searchPath(dungeon, nullptr, resource, path, stats);
+    return path;
+}
 
-    q.push(start);
-    visited.insert(start);
+pmr::vector<Cell> bfsPath(const pmr::vector<pmr::string>& dungeon, pmr::memory_resource* resource) {
+    return bfsPath(Grid::fromStrings(dungeon, resource), resource);
+}
 
-    while (!q.empty()) {
-        Cell cur = q.front(); q.pop();
-        if (cur == goal) return reconstructPath(parents, start, goal);
+// One side of a bidirectional search
+struct SearchSide {
+    BitSet visited;
+    PackedArray<2> parentDir;
+    vector<int> frontier;
 
-        for (int d = 0; d < NUM_DIRECTIONS; d++) {
-            int nr = cur.r + DIRECTIONS[d][0];
-            int nc = cur.c + DIRECTIONS[d][1];
-            if (isValidCell(dungeon, nr, nc)) {
-                char ch = dungeon[nr][nc];
-                if (ch >= 'A' && ch <= 'F') continue; // basic BFS can't go through doors
-                Cell next(nr, nc);
-                if (!visited.count(next)) {
-                    visited.insert(next);
-                    parents[next] = cur;
-                    q.push(next);
+    SearchSide(int size, int root) : visited(size), parentDir(size), frontier{root} {
+        visited.set(root);
+    }
+};
+
+template <typename Stats>
+static vector<Cell> searchBidirectional(const Grid& dungeon, Stats& stats) {
+    int startIdx = dungeon.find('S');
+    int goalIdx = dungeon.find('E');
+    if (startIdx == -1 || goalIdx == -1) return {};
+    stats.phase(SolvePhase::Search);
+
+    SearchSide fromStart(dungeon.size(), startIdx);
+    SearchSide fromGoal(dungeon.size(), goalIdx);
+    vector<int> next;
+    int meet = -1;
+    stats.layers(1);
+    stats.push(2);
+    stats.visit(0, 2);
+
+    // Expand one full layer of the smaller frontier at a time. The first cell
+    // claimed by one side that the other side has already reached lies on a
+    // shortest path, because every cell closer to either root was expanded in
+    // an earlier layer.
+    while (meet == -1 && !fromStart.frontier.empty() && !fromGoal.frontier.empty()) {
+        bool startSide = fromStart.frontier.size() <= fromGoal.frontier.size();
+        SearchSide& side = startSide ? fromStart : fromGoal;
+        const SearchSide& other = startSide ? fromGoal : fromStart;
+
+        next.clear();
+        for (size_t i = 0; i < side.frontier.size() && meet == -1; i++) {
+            int cur = side.frontier[i];
+            stats.pop();
+            for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                int n = cur + dungeon.offset(d);
+                char ch = dungeon[n];
+                if (blocksWithoutKeys(ch)) continue;
+                if (side.visited.testAndSet(n)) continue;
+                side.parentDir.set(n, static_cast<uint8_t>(d));
+                stats.visit(0);
+                if (other.visited.test(n)) {
+                    meet = n;
+                    break;
                 }
+                next.push_back(n);
+                stats.push();
             }
         }
+        side.frontier.swap(next);
+        stats.frontier(fromStart.frontier.size() + fromGoal.frontier.size());
+    }
+    stats.allocated(2 * (fromStart.visited.bytes() + fromStart.parentDir.bytes()) +
+                    capacityBytes(fromStart.frontier) + capacityBytes(fromGoal.frontier) + capacityBytes(next));
+    if (meet == -1) return {};
+    stats.phase(SolvePhase::Reconstruct);
+
+    // Count both halves first so the path is sized once
+    size_t toStart = 0, toGoal = 0;
+    for (int cur = meet; cur != startIdx; cur -= dungeon.offset(fromStart.parentDir.get(cur))) toStart++;
+    for (int cur = meet; cur != goalIdx; cur -= dungeon.offset(fromGoal.parentDir.get(cur))) toGoal++;
+
+    // Start half is filled back to front from the meeting cell; parents on
+    // the goal side point toward the exit, so that half fills forward
+    vector<Cell> path(toStart + toGoal + 1);
+    size_t i = toStart;
+    for (int cur = meet; ; cur -= dungeon.offset(fromStart.parentDir.get(cur))) {
+        path[i] = dungeon.cellAt(cur);
+        if (i-- == 0) break;
     }
-    return {};
+    i = toStart;
+    for (int cur = meet; cur != goalIdx; ) {
+        cur -= dungeon.offset(fromGoal.parentDir.get(cur));
+        path[++i] = dungeon.cellAt(cur);
+    }
+    return path;
+}
+
+vector<Cell> bfsPathBidirectional(const Grid& dungeon) {
+    NoStats stats;
+    return searchBidirectional(dungeon, stats);
+}
+
+vector<Cell> bfsPathBidirectional(const Grid& dungeon, SolverStats& stats) {
+    StatsRecorder recorder(stats);
+    return searchBidirectional(dungeon, recorder);
+}
+
+vector<Cell> bfsPathBidirectional(const vector<string>& dungeon) {
+    return bfsPathBidirectional(Grid::fromStrings(dungeon));
 }
 
-struct State {
-    int row, col, keys;
-    bool operator==(const State& other) const {
-        return row == other.row && col == other.col && keys == other.keys;
+vector<Cell> bfsPath(const Grid& dungeon, SolverStrategy strategy) {
+    switch (strategy) {
+    case SolverStrategy::Bidirectional:
+        return bfsPathBidirectional(dungeon);
+    case SolverStrategy::BitParallel:
+        return bfsPathBitParallel(dungeon);
+    case SolverStrategy::Parallel:
+        return bfsPathParallel(dungeon);
+    case SolverStrategy::AStar:
+        return astarPath(dungeon);
+    case SolverStrategy::JumpPoint:
+        return jpsPath(dungeon);
+    case SolverStrategy::Standard:
+    default:
+        return bfsPath(dungeon);
     }
-};
+}
 
-struct StateHash {
-    size_t operator()(const State& s) const {
-        return ((size_t)s.row << 20) ^ ((size_t)s.col << 10) ^ s.keys;
+vector<Cell> bfsPath(const Grid& dungeon, SolverStrategy strategy, SolverStats& stats) {
+    switch (strategy) {
+    case SolverStrategy::Bidirectional:
+        return bfsPathBidirectional(dungeon, stats);
+    case SolverStrategy::BitParallel:
+        return bfsPathBitParallel(dungeon, stats);
+    case SolverStrategy::Parallel:
+        return bfsPathParallel(dungeon, stats);
+    case SolverStrategy::AStar:
+        return astarPath(dungeon, stats);
+    case SolverStrategy::JumpPoint:
+        return jpsPath(dungeon, stats);
+    case SolverStrategy::Standard:
+    default:
+        return bfsPath(dungeon, stats);
     }
-};
+}
+
+vector<Cell> bfsPath(const vector<string>& dungeon, SolverStrategy strategy) {
+    return bfsPath(Grid::fromStrings(dungeon), strategy);
+}
+
+bool canPassDoor(char door, int keyMask) {
+    return (keyMask >> (door - 'A')) & 1;
+}
 
+int collectKey(char key, int keyMask) {
+    return keyMask | (1 << (key - 'a'));
+}
+
+// bfsPathKeys with every temporary allocated from resource, reporting to a
+// stats policy. The key-graph shortcut is 4-connected only.
+template <int NumKeys, typename Moves = FourConnected, typename Path, typename Stats>
+static void searchPathKeys(const Grid& dungeon, const LevelIndex* level, pmr::memory_resource* resource,
+                           Path& path, Stats& stats) {
+    // One pass finds S, E, the keys and the doors
+    LevelIndex built(resource);
+    if (!level) {
+        indexLevel(dungeon, built);
+        level = &built;
+    }
+    int startIdx = level->start;
+    int goalIdx = level->goal;
+    if (startIdx == -1 || goalIdx == -1) return;
+    stats.phase(SolvePhase::Search);
+
+    // Key layers are only allocated for keys that actually appear in the dungeon
+    TileMap tiles(dungeon, *level, NumKeys, resource);
+
+    // Few keys on a big map: searching between points of interest is cheaper
+    // than exploring every key layer of the full grid
+    if (Moves::SIZE == 4 && keyGraphIsCheaper(tiles)) {
+        stats.usedKeyGraph();
+        vector<Cell> route = keyGraphPath(dungeon, *level, tiles);
+        path.assign(route.begin(), route.end());
+        return;
+    }
+
+    // One full grid layer per key mask (see BfsKernel)
+    RowMajorLayout layout(dungeon);
+    KeyDoorRule<NumKeys> rule(tiles);
+    BfsKernel<Moves, KeyDoorRule<NumKeys>, RowMajorLayout> bfs(layout, rule, resource);
+    int depth = bfs.run(startIdx, stats, [goalIdx](int cell, typename KeyDoorRule<NumKeys>::Mask) {
+        return cell == goalIdx;
+    });
+    if (depth < 0) return;
+    stats.phase(SolvePhase::Reconstruct);
+    bfs.path(depth, path);
+}
+
+template <int NumKeys>
+vector<Cell> bfsPathKeys(const Grid& dungeon) {
+    vector<Cell> path;
+    NoStats stats;
+    searchPathKeys<NumKeys>(dungeon, nullptr, pmr::get_default_resource(), path, stats);
+    return path;
+}
+
+template vector<Cell> bfsPathKeys<6>(const Grid& dungeon);
+template vector<Cell> bfsPathKeys<16>(const Grid& dungeon);
+template vector<Cell> bfsPathKeys<26>(const Grid& dungeon);
+
+template <int NumKeys>
 vector<Cell> bfsPathKeys(const vector<string>& dungeon) {
-    Cell start = findPosition(dungeon, 'S');
-    Cell goal = findPosition(dungeon, 'E');
-    if (start.r == -1 || goal.r == -1) return {};
-
-    queue<State> q;
-    unordered_map<State, State, StateHash> parent;
-    unordered_set<State, StateHash> visited;
-
-    State startState{start.r, start.c, 0};
-    q.push(startState);
-    visited.insert(startState);
-
-    while (!q.empty()) {
-        State cur = q.front(); q.pop();
-        if (cur.row == goal.r && cur.col == goal.c) {
-            // reconstruct path
-            vector<Cell> path;
-            State s = cur;
-            while (!(s.row == start.r && s.col == start.c && s.keys == 0)) {
-                path.push_back(Cell(s.row, s.col));
-                s = parent[s];
-            }
-            path.push_back(start);
-            reverse(path.begin(), path.end());
-            return path;
-        }
+    return bfsPathKeys<NumKeys>(Grid::fromStrings(dungeon));
+}
 
-        for (int d = 0; d < NUM_DIRECTIONS; d++) {
-            int nr = cur.row + DIRECTIONS[d][0];
-            int nc = cur.col + DIRECTIONS[d][1];
-            if (!isValidCell(dungeon, nr, nc)) continue;
+template vector<Cell> bfsPathKeys<6>(const vector<string>& dungeon);
+template vector<Cell> bfsPathKeys<16>(const vector<string>& dungeon);
+template vector<Cell> bfsPathKeys<26>(const vector<string>& dungeon);
 
-            char ch = dungeon[nr][nc];
-            int newKeys = cur.keys;
+vector<Cell> bfsPathKeys(const Grid& dungeon) {
+    return bfsPathKeys<DEFAULT_NUM_KEYS>(dungeon);
+}
 
-            if (ch >= 'A' && ch <= 'F') {
-                int keyBit = ch - 'A';
-                if (!((newKeys >> keyBit) & 1)) continue; // door locked
-            }
-            if (ch >= 'a' && ch <= 'f') {
-                int keyBit = ch - 'a';
-                newKeys |= (1 << keyBit); // collect key
-            }
+vector<Cell> bfsPathKeys(const vector<string>& dungeon) {
+    return bfsPathKeys(Grid::fromStrings(dungeon));
+}
 
-            State next{nr, nc, newKeys};
-            if (!visited.count(next)) {
-                visited.insert(next);
-                parent[next] = cur;
-                q.push(next);
-            }
-        }
+vector<Cell> bfsPathKeys(const Grid& dungeon, const LevelIndex& level) {
+    vector<Cell> path;
+    NoStats stats;
+    searchPathKeys<DEFAULT_NUM_KEYS>(dungeon, &level, pmr::get_default_resource(), path, stats);
+    return path;
+}
+
+vector<Cell> bfsPathKeys(const Grid& dungeon, Connectivity moves) {
+    vector<Cell> path;
+    NoStats stats;
+    if (moves == Connectivity::Eight) {
+        searchPathKeys<DEFAULT_NUM_KEYS, EightConnected>(dungeon, nullptr, pmr::get_default_resource(), path, stats);
+    } else {
+        searchPathKeys<DEFAULT_NUM_KEYS>(dungeon, nullptr, pmr::get_default_resource(), path, stats);
     }
-    return {};
+    return path;
 }
 
-#ifdef IMPLEMENT_OPTIONAL_FUNCTIONS
-int countReachableKeys(const std::vector<std::string>& dungeon) {
-    Cell start = findPosition(dungeon, 'S');
-    if (start.r == -1) return 0;
-    queue<Cell> q;
-    unordered_set<Cell, CellHash> visited;
-    int keys = 0;
-
-    q.push(start);
-    visited.insert(start);
-
-    while (!q.empty()) {
-        Cell cur = q.front(); q.pop();
-        char ch = dungeon[cur.r][cur.c];
-        if (ch >= 'a' && ch <= 'f') {
-            keys |= (1 << (ch - 'a'));
-        }
+vector<Cell> bfsPathKeys(const Grid& dungeon, SolverStats& stats) {
+    vector<Cell> path;
+    CountingResource counting(pmr::get_default_resource());
+    {
+        StatsRecorder recorder(stats);
+        searchPathKeys<DEFAULT_NUM_KEYS>(dungeon, nullptr, &counting, path, recorder);
+    }
+    stats.bytesAllocated = counting.bytes();
+    return path;
+}
+
+pmr::vector<Cell> bfsPathKeys(const Grid& dungeon, pmr::memory_resource* resource) {
+    pmr::vector<Cell> path(resource);
+    NoStats stats;
+    searchPathKeys<DEFAULT_NUM_KEYS>(dungeon, nullptr, resource, path, stats);
+    return path;
+}
+
+pmr::vector<Cell> bfsPathKeys(const pmr::vector<pmr::string>& dungeon, pmr::memory_resource* resource) {
+    return bfsPathKeys(Grid::fromStrings(dungeon, resource), resource);
+}
+
+int bfsDistance(const Grid& dungeon) {
+    // No path is rebuilt, so the bit-parallel flood fill needs only its frontier
+    return bfsDistanceBitParallel(dungeon);
+}
+
+int bfsDistance(const vector<string>& dungeon) {
+    return bfsDistance(Grid::fromStrings(dungeon));
+}
+
+bool isSolvable(const Grid& dungeon) {
+    return bfsDistance(dungeon) >= 0;
+}
+
+bool isSolvable(const vector<string>& dungeon) {
+    return isSolvable(Grid::fromStrings(dungeon));
+}
+
+// Keys are never used up, so the reachable area only grows as keys are
+// found: one flood fill over cells (not key states) is enough. A locked
+// door is parked until its key is reached, then joins the queue.
+static bool keysReachGoal(const Grid& dungeon, const TileMap& tiles, int startIdx, int goalIdx) {
+    BitSet visited(dungeon.size());
+    vector<vector<int>> parked(tiles.numKeys());
+    vector<int> q{startIdx};
+    uint32_t keys = 0;
+    visited.set(startIdx);
+
+    for (size_t head = 0; head < q.size(); head++) {
+        int cur = q[head];
+        if (cur == goalIdx) return true;
         for (int d = 0; d < NUM_DIRECTIONS; d++) {
-            int nr = cur.r + DIRECTIONS[d][0];
-            int nc = cur.c + DIRECTIONS[d][1];
-            if (isValidCell(dungeon, nr, nc)) {
-                Cell next(nr, nc);
-                if (!visited.count(next)) {
-                    visited.insert(next);
-                    q.push(next);
-                }
+            int next = cur + dungeon.offset(d);
+            uint8_t tile = tiles[next];
+            if (tile == TILE_WALL || visited.testAndSet(next)) continue;
+
+            int bit = tile & TILE_BIT_MASK;
+            if ((tile & TILE_DOOR) && !((keys >> bit) & 1)) {
+                parked[bit].push_back(next);
+                continue;
+            }
+            q.push_back(next);
+            if ((tile & TILE_KEY) && !((keys >> bit) & 1)) {
+                keys |= 1u << bit;
+                q.insert(q.end(), parked[bit].begin(), parked[bit].end());
+                parked[bit].clear();
             }
         }
     }
+    return false;
+}
+
+bool isSolvableKeys(const Grid& dungeon) {
+    LevelIndex level = indexLevel(dungeon);
+    if (level.start == -1 || level.goal == -1) return false;
+    return keysReachGoal(dungeon, TileMap(dungeon, level, DEFAULT_NUM_KEYS), level.start, level.goal);
+}
+
+bool isSolvableKeys(const vector<string>& dungeon) {
+    return isSolvableKeys(Grid::fromStrings(dungeon));
+}
+
+int bfsDistanceKeys(const Grid& dungeon) {
+    LevelIndex level = indexLevel(dungeon);
+    int startIdx = level.start;
+    int goalIdx = level.goal;
+    if (startIdx == -1 || goalIdx == -1) return -1;
+
+    // The cheap flood fill rules out unsolvable dungeons before the layered
+    // search, which would otherwise exhaust every reachable key layer
+    TileMap tiles(dungeon, level, DEFAULT_NUM_KEYS);
+    if (!keysReachGoal(dungeon, tiles, startIdx, goalIdx)) return -1;
+    if (keyGraphIsCheaper(tiles)) return static_cast<int>(keyGraphPath(dungeon, level, tiles).size()) - 1;
+
+    // Layered search as in bfsPathKeys, with visited bits but no parents
+    RowMajorLayout layout(dungeon);
+    KeyDoorRule<DEFAULT_NUM_KEYS> rule(tiles);
+    BfsKernel<FourConnected, KeyDoorRule<DEFAULT_NUM_KEYS>, RowMajorLayout, false> bfs(layout, rule);
+    NoStats stats;
+    return bfs.run(startIdx, stats, [goalIdx](int cell, KeyDoorRule<DEFAULT_NUM_KEYS>::Mask) {
+        return cell == goalIdx;
+    });
+}
+
+int bfsDistanceKeys(const vector<string>& dungeon) {
+    return bfsDistanceKeys(Grid::fromStrings(dungeon));
+}
+
+#ifdef IMPLEMENT_OPTIONAL_FUNCTIONS
+int countReachableKeys(const Grid& dungeon) {
+    LevelIndex level = indexLevel(dungeon);
+    int startIdx = level.start;
+    if (startIdx == -1) return 0;
+    TileMap tiles(dungeon, level, DEFAULT_NUM_KEYS);
+    BitSet keysFound(tiles.numKeys());
     int count = 0;
-    for (int i = 0; i < 6; i++) {
-        if ((keys >> i) & 1) count++;
-    }
+
+    // Flood fill that ignores doors, counting each key letter once
+    RowMajorLayout layout(dungeon);
+    PlainRule<RowMajorLayout> rule(layout);
+    BfsKernel<FourConnected, PlainRule<RowMajorLayout>, RowMajorLayout, false> bfs(layout, rule);
+    NoStats stats;
+    bfs.run(startIdx, stats, [&](int cell, uint8_t) {
+        uint8_t tile = tiles[cell];
+        if ((tile & TILE_KEY) && !keysFound.testAndSet(tile & TILE_BIT_MASK)) count++;
+        return false;
+    });
     return count;
 }
+
+int countReachableKeys(const std::vector<std::string>& dungeon) {
+    return countReachableKeys(Grid::fromStrings(dungeon));
+}
 #else
 int countReachableKeys(const std::vector<std::string>&) {
     return 0;
@@ -1,7 +1,23 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <memory_resource>
 #include "cell.h"
+#include "grid.h"
+#include "solver_stats.h"
+#include "level_index.h"
+#include "grid_layout.h"
+
+/**
+ * Which steps a search may take: the four orthogonal ones, or those plus
+ * the four diagonals. A diagonal step costs one move like any other and
+ * needs both orthogonal tiles it passes to be open, so it never cuts a
+ * wall corner.
+ */
+enum class Connectivity {
+    Four,
+    Eight
+};
 
 /**
  * Finds the shortest path from start 'S' to exit 'E' in the dungeon
@@ -13,6 +29,116 @@
  *         Returns empty vector if no path exists.
  */
 std::vector<Cell> bfsPath(const std::vector<std::string>& dungeon);
+std::vector<Cell> bfsPath(const Grid& dungeon);
+
+/**
+ * bfsPath with S and E taken from a level index (see level_index.h), for
+ * callers that already have one, such as a generated level's
+ * DungeonSolution::level. The dungeon is not scanned at all.
+ *
+ * @param dungeon The dungeon to solve
+ * @param level indexLevel of dungeon
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPath(const Grid& dungeon, const LevelIndex& level);
+
+/**
+ * bfsPath in a chosen memory layout (see grid_layout.h). The other
+ * overloads use GridLayout::Auto: grids of TILED_LAYOUT_MIN_TILES tiles
+ * and more are copied into 64x64-tile blocks first, so the search and its
+ * visited and parent arrays touch far fewer pages; smaller ones are
+ * searched in place. Every layout returns the same path.
+ *
+ * @param dungeon The dungeon to solve
+ * @param layout Layout to search in
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPath(const Grid& dungeon, GridLayout layout);
+
+/**
+ * bfsPath with a chosen neighborhood (see Connectivity). Four is what the
+ * other overloads do; Eight instantiates the same kernel with diagonal
+ * steps, so its path can be shorter than validatePath allows.
+ *
+ * @param dungeon The dungeon to solve
+ * @param moves Four- or eight-connected movement
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPath(const Grid& dungeon, Connectivity moves);
+
+/**
+ * bfsPath with the path and every search temporary (visited bits, parent
+ * records, queue, and the Grid for string input) allocated from resource.
+ * With a std::pmr::monotonic_buffer_resource per request, everything is
+ * released at once when the arena is dropped.
+ *
+ * @param dungeon The dungeon to solve
+ * @param resource Memory resource for the result and temporaries
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::pmr::vector<Cell> bfsPath(const Grid& dungeon, std::pmr::memory_resource* resource);
+std::pmr::vector<Cell> bfsPath(const std::pmr::vector<std::pmr::string>& dungeon,
+                               std::pmr::memory_resource* resource);
+
+/**
+ * Search engines that bfsPath can run. All of them return a shortest path
+ * (same length as Standard) that passes validatePath, so they can be
+ * benchmarked side by side on the same inputs.
+ */
+enum class SolverStrategy {
+    Standard,       // single-source BFS from S
+    Bidirectional,  // BFS from S and E at once, meeting in the middle
+    BitParallel,    // bitboard flood fill, 64 cells per word (see bitbfs.h)
+    Parallel,       // multi-threaded level-synchronous BFS (see parallel_bfs.h)
+    AStar,          // A* with Manhattan heuristic and bucket queue (see astar.h)
+    JumpPoint       // Jump Point Search over open rooms (see astar.h)
+};
+
+/**
+ * Movement rules for solvers that support both: those of bfsPath (doors
+ * block) or of bfsPathKeys (keys 'a'-'f' open doors 'A'-'F').
+ */
+enum class SolveRules {
+    Basic,
+    Keys
+};
+
+/**
+ * bfsPath with an explicit choice of search engine.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @param strategy Which search engine to run
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPath(const std::vector<std::string>& dungeon, SolverStrategy strategy);
+std::vector<Cell> bfsPath(const Grid& dungeon, SolverStrategy strategy);
+
+/**
+ * Instrumented bfsPath: the same search, also filling stats with node
+ * counts, frontier size, bytes allocated and per-phase times (see
+ * solver_stats.h). stats is reset first. The overloads without stats run
+ * the same code with the empty NoStats policy, so they pay nothing for it.
+ *
+ * @param dungeon The dungeon to solve
+ * @param strategy Which search engine to run
+ * @param stats Filled with what the search did
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPath(const Grid& dungeon, SolverStats& stats);
+std::vector<Cell> bfsPath(const Grid& dungeon, SolverStrategy strategy, SolverStats& stats);
+
+/**
+ * Bidirectional BFS: searches from S and E simultaneously, always expanding
+ * the smaller frontier by one full layer, until the two searches meet.
+ * On large open dungeons this explores far fewer cells than bfsPath.
+ * Doors block movement, as in bfsPath.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathBidirectional(const std::vector<std::string>& dungeon);
+std::vector<Cell> bfsPathBidirectional(const Grid& dungeon);
+std::vector<Cell> bfsPathBidirectional(const Grid& dungeon, SolverStats& stats);
 
 /**
  * Advanced pathfinding that handles keys and doors using state augmentation.
@@ -25,6 +151,110 @@ std::vector<Cell> bfsPath(const std::vector<std::string>& dungeon);
  *         Returns empty vector if no path exists.
  */
 std::vector<Cell> bfsPathKeys(const std::vector<std::string>& dungeon);
+std::vector<Cell> bfsPathKeys(const Grid& dungeon);
+
+/**
+ * Instrumented bfsPathKeys (see the stats overload of bfsPath).
+ * layerStates gets one entry per key layer. When the key-graph solver
+ * takes the map, keyGraph is set and the state counters stay 0.
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @param stats Filled with what the search did
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathKeys(const Grid& dungeon, SolverStats& stats);
+
+/**
+ * bfsPathKeys with S, E, keys and doors taken from a level index, so the
+ * tile classes are built without reading any letter of the dungeon.
+ * Without one, bfsPathKeys indexes the dungeon itself in one pass.
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @param level indexLevel of dungeon
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathKeys(const Grid& dungeon, const LevelIndex& level);
+
+/**
+ * bfsPathKeys with a chosen neighborhood (see Connectivity). With Eight
+ * the layered search always runs, since the key graph is 4-connected.
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @param moves Four- or eight-connected movement
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::vector<Cell> bfsPathKeys(const Grid& dungeon, Connectivity moves);
+
+/**
+ * bfsPathKeys with the path and search temporaries allocated from resource
+ * (see the arena overload of bfsPath).
+ *
+ * @param dungeon The dungeon to solve
+ * @param resource Memory resource for the result and temporaries
+ * @return Path from S to E, or empty vector if no path exists
+ */
+std::pmr::vector<Cell> bfsPathKeys(const Grid& dungeon, std::pmr::memory_resource* resource);
+std::pmr::vector<Cell> bfsPathKeys(const std::pmr::vector<std::pmr::string>& dungeon,
+                                   std::pmr::memory_resource* resource);
+
+// Key alphabet size used by bfsPathKeys when none is given ('a'-'f')
+const int DEFAULT_NUM_KEYS = 6;
+
+/**
+ * bfsPathKeys over a key alphabet of NumKeys keys ('a' onward, with matching
+ * doors 'A' onward); letters past the alphabet are plain floor. The collected
+ * key mask is stored in the smallest integer type that fits (see KeyAlphabet
+ * in tiles.h). Instantiated for 6, 16 and 26 keys.
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @return Vector of Cell coordinates representing the path from S to E.
+ *         Returns empty vector if no path exists.
+ */
+template <int NumKeys>
+std::vector<Cell> bfsPathKeys(const std::vector<std::string>& dungeon);
+template <int NumKeys>
+std::vector<Cell> bfsPathKeys(const Grid& dungeon);
+
+/**
+ * Length of the shortest path from S to E without building it. Uses the
+ * bit-parallel flood fill with only its current frontier, so no parent
+ * records are kept at all. Same rules as bfsPath (doors block).
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return Number of moves from S to E (path size - 1), or -1 if unreachable
+ */
+int bfsDistance(const std::vector<std::string>& dungeon);
+int bfsDistance(const Grid& dungeon);
+
+/**
+ * Whether E is reachable from S under bfsPath rules; stops at the first
+ * contact with E.
+ *
+ * @param dungeon 2D grid represented as vector of strings
+ * @return true if a path exists
+ */
+bool isSolvable(const std::vector<std::string>& dungeon);
+bool isSolvable(const Grid& dungeon);
+
+/**
+ * Distance version of bfsPathKeys: visited bits only, no parent records.
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @return Number of moves from S to E (path size - 1), or -1 if unreachable
+ */
+int bfsDistanceKeys(const std::vector<std::string>& dungeon);
+int bfsDistanceKeys(const Grid& dungeon);
+
+/**
+ * Whether E is reachable under bfsPathKeys rules. Since keys are never
+ * used up, this is a single flood fill over cells that parks locked doors
+ * until their key is reached: O(cells) instead of O(cells * 2^keys).
+ *
+ * @param dungeon 2D grid with walls, open spaces, start, exit, keys and doors
+ * @return true if a path exists
+ */
+bool isSolvableKeys(const std::vector<std::string>& dungeon);
+bool isSolvableKeys(const Grid& dungeon);
 
 /**
  * Helper function to find the position of a specific character in the dungeon.
@@ -35,6 +265,7 @@ std::vector<Cell> bfsPathKeys(const std::vector<std::string>& dungeon);
  * @return Cell containing the position, or Cell(-1, -1) if not found
  */
 Cell findPosition(const std::vector<std::string>& dungeon, char target);
+Cell findPosition(const Grid& dungeon, char target);
 
 /**
  * Helper function to check if a position is valid and passable.
@@ -46,12 +277,13 @@ Cell findPosition(const std::vector<std::string>& dungeon, char target);
  * @return true if the position is valid and passable, false otherwise
  */
 bool isPassable(const std::vector<std::string>& dungeon, int row, int col);
+bool isPassable(const Grid& dungeon, int row, int col);
 
 /**
  * Helper function to check if a door can be passed given the current key collection.
  * For door 'A', you need key 'a' (bit 0 set), for door 'B', you need key 'b' (bit 1 set), etc.
  * 
- * @param door The door character ('A'-'F')
+ * @param door The door character ('A'-'Z')
  * @param keyMask Bitmask representing collected keys (bit 0 = 'a', bit 1 = 'b', etc.)
  * @return true if the door can be passed, false otherwise
  */
@@ -61,7 +293,7 @@ bool canPassDoor(char door, int keyMask);
  * Helper function to update the key collection when stepping on a key.
  * For key 'a', set bit 0, for key 'b', set bit 1, etc.
  * 
- * @param key The key character ('a'-'f')
+ * @param key The key character ('a'-'z')
  * @param keyMask Current bitmask of collected keys
  * @return Updated bitmask with the new key added
  */
@@ -86,4 +318,5 @@ int collectKey(char key, int keyMask);
  * @return Number of unique keys reachable from start position
  */
 int countReachableKeys(const std::vector<std::string>& dungeon);
+int countReachableKeys(const Grid& dungeon);
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "solver_stats.h"
+#include <cstdio>
+#include <numeric>
+#include <string>
+
+using namespace std;
+
+static const char* const PHASE_NAMES[NUM_SOLVE_PHASES] = {"findEndpoints", "search", "reconstruct"};
+
+uint64_t SolverStats::visited() const {
+    return accumulate(layerStates.begin(), layerStates.end(), uint64_t(0));
+}
+
+string toJson(const SolverStats& stats) {
+    string json = "{\"pushed\":" + to_string(stats.pushed) +
+                  ",\"popped\":" + to_string(stats.popped) +
+                  ",\"maxFrontier\":" + to_string(stats.maxFrontier) +
+                  ",\"visited\":" + to_string(stats.visited()) + ",\"layerStates\":[";
+    for (size_t i = 0; i < stats.layerStates.size(); i++) {
+        if (i > 0) json += ',';
+        json += to_string(stats.layerStates[i]);
+    }
+    json += "],\"bytesAllocated\":" + to_string(stats.bytesAllocated) + ",\"phaseSeconds\":{";
+    for (int p = 0; p < NUM_SOLVE_PHASES; p++) {
+        // %.9g keeps nanosecond resolution and is always valid JSON
+        char seconds[32];
+        snprintf(seconds, sizeof(seconds), "%.9g", stats.phaseSeconds[p]);
+        if (p > 0) json += ',';
+        json += string("\"") + PHASE_NAMES[p] + "\":" + seconds;
+    }
+    json += string("},\"keyGraph\":") + (stats.keyGraph ? "true" : "false") + "}";
+    return json;
+}
+
+StatsRecorder::StatsRecorder(SolverStats& stats) : stats_(stats) {
+    stats_ = SolverStats();
+    started_ = chrono::steady_clock::now();
+}
+
+StatsRecorder::~StatsRecorder() {
+    phase(phase_);
+}
+
+void StatsRecorder::phase(SolvePhase next) {
+    auto now = chrono::steady_clock::now();
+    stats_.phaseSeconds[static_cast<int>(phase_)] += chrono::duration<double>(now - started_).count();
+    phase_ = next;
+    started_ = now;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory_resource>
+
+/**
+ * Phases of one solve, timed separately in SolverStats.
+ */
+enum class SolvePhase {
+    FindEndpoints,  // locating S and E
+    Search,         // search setup (visited bits, tile classes) and the search
+    Reconstruct     // rebuilding the path from parent records
+};
+const int NUM_SOLVE_PHASES = 3;
+
+/**
+ * What one solve did, filled by the solver overloads that take a
+ * SolverStats. A state is a cell for the plain solvers and a (keys, cell)
+ * pair for the key solvers.
+ */
+struct SolverStats {
+    uint64_t pushed = 0;       // states added to the queue, open list or frontier
+    uint64_t popped = 0;       // states taken off it and expanded (stale A* entries too)
+    uint64_t maxFrontier = 0;  // most states waiting at once
+
+    // States visited on each key layer, indexed by compact key mask (see
+    // TileMap); a single entry for the solvers without keys
+    std::vector<uint64_t> layerStates;
+
+    // Bytes of search buffers: every allocation through the memory resource
+    // for bfsPath and bfsPathKeys, final buffer capacities for the others
+    uint64_t bytesAllocated = 0;
+
+    double phaseSeconds[NUM_SOLVE_PHASES] = {};
+
+    // bfsPathKeys handed the map to the key-graph solver, which is not
+    // instrumented: the state counters stay 0
+    bool keyGraph = false;
+
+    // Total states visited, over every key layer
+    uint64_t visited() const;
+};
+
+/**
+ * One-line JSON object with every SolverStats field, for collecting stats
+ * from many solves. Phase times are in seconds, keyed by phase name.
+ *
+ * @param stats Stats to export
+ * @return JSON text, without a trailing newline
+ */
+std::string toJson(const SolverStats& stats);
+
+/**
+ * Stats policy of the plain solver entry points. Every hook is an empty
+ * inline function and `enabled` is false, so the instrumented search code
+ * compiles to the uninstrumented loop.
+ */
+struct NoStats {
+    static constexpr bool enabled = false;
+    void phase(SolvePhase) {}
+    void push(uint64_t = 1) {}
+    void pop(uint64_t = 1) {}
+    void frontier(uint64_t) {}
+    void layers(uint64_t) {}
+    void visit(uint64_t, uint64_t = 1) {}
+    void allocated(uint64_t) {}
+    void usedKeyGraph() {}
+};
+
+/**
+ * Stats policy that records into a SolverStats. Construction resets the
+ * stats and starts timing FindEndpoints; phase() ends the running phase
+ * and starts the next, and destruction ends the last one.
+ */
+class StatsRecorder {
+public:
+    static constexpr bool enabled = true;
+
+    explicit StatsRecorder(SolverStats& stats);
+    ~StatsRecorder();
+
+    StatsRecorder(const StatsRecorder&) = delete;
+    StatsRecorder& operator=(const StatsRecorder&) = delete;
+
+    void phase(SolvePhase next);
+    void push(uint64_t count = 1) { stats_.pushed += count; }
+    void pop(uint64_t count = 1) { stats_.popped += count; }
+    void frontier(uint64_t size) {
+        if (size > stats_.maxFrontier) stats_.maxFrontier = size;
+    }
+
+    // Sizes layerStates before the first visit()
+    void layers(uint64_t count) { stats_.layerStates.assign(count, 0); }
+    void visit(uint64_t layer, uint64_t count = 1) { stats_.layerStates[layer] += count; }
+    void allocated(uint64_t bytes) { stats_.bytesAllocated += bytes; }
+    void usedKeyGraph() { stats_.keyGraph = true; }
+
+private:
+    SolverStats& stats_;
+    SolvePhase phase_ = SolvePhase::FindEndpoints;
+    std::chrono::steady_clock::time_point started_;
+};
+
+/**
+ * Memory resource that passes every request to an upstream resource and
+ * adds up the bytes allocated through it.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        bytes_ += bytes;
+        return upstream_->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(pointer, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    uint64_t bytes_ = 0;
+};
+
+// Bytes held by a vector's buffer
+template <typename Vector>
+uint64_t capacityBytes(const Vector& buffer) {
+    return buffer.capacity() * sizeof(typename Vector::value_type);
+}
@@ -0,0 +1,143 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+// Index of the pool worker running the current thread
+static thread_local int currentWorker = 0;
+
+ThreadPool::ThreadPool(int threads) {
+    threads = max(threads, 1);
+    for (int i = 0; i < threads; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    taskReady_.notify_all();
+    for (thread& worker : workers_) worker.join();
+}
+
+void ThreadPool::submit(function<void()> task) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        tasks_.push_back(move(task));
+        pending_++;
+    }
+    taskReady_.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(mutex_);
+    allDone_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minChunk,
+                             const function<void(size_t, size_t, int)>& fn) {
+    if (count == 0) return;
+    // A few chunks per worker so an uneven split still keeps everyone busy
+    size_t chunk = max(minChunk, (count + workers_.size() * 4 - 1) / (workers_.size() * 4));
+    for (size_t begin = 0; begin < count; begin += chunk) {
+        size_t end = min(count, begin + chunk);
+        submit([&fn, begin, end] { fn(begin, end, currentWorker); });
+    }
+    wait();
+}
+
+void ThreadPool::parallelForStealing(size_t count, const function<void(size_t, int)>& fn) {
+    if (count == 0) return;
+    if (count > 0xFFFFFFFFull) {
+        // Ranges are packed into 32-bit halves; fall back to plain chunks
+        parallelFor(count, 1, [&fn](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) fn(i, worker);
+        });
+        return;
+    }
+
+    // Range of slot w packed as begin << 32 | end, so the owner taking from
+    // the front and thieves taking from the back both use one CAS
+    const uint64_t LOW = 0xFFFFFFFFull;
+    const size_t slots = workers_.size();
+    unique_ptr<atomic<uint64_t>[]> ranges(new atomic<uint64_t>[slots]);
+    auto pack = [](uint64_t begin, uint64_t end) { return begin << 32 | end; };
+    auto left = [LOW](uint64_t range) {
+        return (range >> 32) < (range & LOW) ? (range & LOW) - (range >> 32) : 0;
+    };
+    for (size_t w = 0; w < slots; w++) {
+        ranges[w].store(pack(count * w / slots, count * (w + 1) / slots));
+    }
+
+    for (size_t w = 0; w < slots; w++) {
+        submit([&, w] {
+            atomic<uint64_t>& own = ranges[w];
+            for (;;) {
+                uint64_t range = own.load();
+                if (left(range)) {
+                    uint64_t begin = range >> 32;
+                    if (own.compare_exchange_weak(range, pack(begin + 1, range & LOW))) {
+                        fn(static_cast<size_t>(begin), currentWorker);
+                    }
+                    continue;
+                }
+
+                // Own range is empty: steal the back half of the largest one
+                size_t victim = slots;
+                uint64_t most = 0;
+                for (size_t v = 0; v < slots; v++) {
+                    uint64_t remaining = left(ranges[v].load());
+                    if (remaining > most) {
+                        most = remaining;
+                        victim = v;
+                    }
+                }
+                if (victim == slots) return;  // nothing left anywhere
+
+                uint64_t target = ranges[victim].load();
+                if (!left(target)) continue;
+                uint64_t end = target & LOW;
+                uint64_t split = end - (left(target) + 1) / 2;
+                if (ranges[victim].compare_exchange_strong(target, pack(target >> 32, split))) {
+                    own.store(pack(split, end));
+                }
+            }
+        });
+    }
+    wait();
+}
+
+void ThreadPool::workerLoop(int worker) {
+    currentWorker = worker;
+    for (;;) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(mutex_);
+            taskReady_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;  // stopping and drained
+            task = move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (--pending_ == 0) allDone_.notify_all();
+        }
+    }
+}
+
+static atomic<int> solverThreadOverride(0);
+
+int solverThreads() {
+    int threads = solverThreadOverride.load();
+    if (threads > 0) return threads;
+    return max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+void setSolverThreads(int threads) {
+    solverThreadOverride.store(max(threads, 0));
+}
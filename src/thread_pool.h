@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+/**
+ * Fixed-size pool of worker threads used by the parallel solvers.
+ * Tasks are plain callables; parallelFor splits an index range into chunks
+ * and blocks until every chunk has run.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads Number of worker threads (at least 1)
+     */
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    // Queues a task to run on some worker
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task has finished
+    void wait();
+
+    /**
+     * Runs fn(begin, end, worker) over [0, count) in chunks of at least
+     * minChunk indices, with worker in [0, size()) identifying the thread so
+     * callers can keep per-thread buffers. Blocks until all chunks are done.
+     */
+    void parallelFor(size_t count, size_t minChunk,
+                     const std::function<void(size_t, size_t, int)>& fn);
+
+    /**
+     * Runs fn(index, worker) for every index in [0, count) with work
+     * stealing: each worker starts on its own contiguous range and, once it
+     * runs dry, takes the back half of the largest range left elsewhere.
+     * Suits jobs of uneven cost without one shared queue. Blocks until all
+     * indices are done.
+     */
+    void parallelForStealing(size_t count, const std::function<void(size_t, int)>& fn);
+
+private:
+    void workerLoop(int worker);
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable taskReady_, allDone_;
+    size_t pending_ = 0;
+    bool stopping_ = false;
+};
+
+/**
+ * Default thread count for the parallel solvers. Starts at the hardware
+ * concurrency; setSolverThreads(n) overrides it (n <= 0 restores the default).
+ */
+int solverThreads();
+void setSolverThreads(int threads);
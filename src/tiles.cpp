@@ -0,0 +1,63 @@
+#include "tiles.h"
+#include <vector>
+#include <cstring>
+
+using namespace std;
+
+TileMap::TileMap(const Grid& dungeon, int alphabetSize, pmr::memory_resource* resource)
+    : tiles_(resource), index_(resource) {
+    assign(dungeon, alphabetSize);
+}
+
+TileMap::TileMap(const Grid& dungeon, const LevelIndex& index, int alphabetSize,
+                 pmr::memory_resource* resource)
+    : tiles_(resource), index_(resource) {
+    assign(dungeon, index, alphabetSize);
+}
+
+void TileMap::assign(const Grid& dungeon, int alphabetSize) {
+    indexLevel(dungeon, index_);
+    assign(dungeon, index_, alphabetSize);
+}
+
+void TileMap::assign(const Grid& dungeon, const LevelIndex& index, int alphabetSize) {
+    // Walls and floor, eight tiles at a time: bytesEqual leaves exactly
+    // TILE_WALL in every wall byte and TILE_FLOOR in the others
+    static_assert(TILE_WALL == 0x80 && TILE_FLOOR == 0, "tile classes must match the byte compare");
+    const size_t size = static_cast<size_t>(dungeon.size());
+    tiles_.resize(size);
+    const char* source = dungeon.data();
+    uint8_t* classes = tiles_.data();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word = bytesEqual(loadBytes(source + i), '#');
+        memcpy(classes + i, &word, sizeof(word));
+    }
+    for (; i < size; i++) classes[i] = source[i] == '#' ? TILE_WALL : TILE_FLOOR;
+
+    // Keys are numbered in order of first appearance. Doors are resolved
+    // afterwards, once we know which keys exist.
+    numKeys_ = 0;
+    keyTiles_ = 0;
+    openCells_ = index.openCells;
+    int keyBit[26];
+    for (int& bit : keyBit) bit = -1;
+    for (int idx : index.keys) {
+        char ch = dungeon[idx];
+        if (ch >= 'a' + alphabetSize) continue;  // plain floor
+        int letter = ch - 'a';
+        if (keyBit[letter] == -1) {
+            keyBit[letter] = numKeys_;
+            letters_[numKeys_++] = ch;
+        }
+        tiles_[idx] = static_cast<uint8_t>(TILE_KEY | keyBit[letter]);
+        keyTiles_++;
+    }
+    for (int idx : index.doors) {
+        char ch = dungeon[idx];
+        if (ch >= 'A' + alphabetSize) continue;
+        int bit = keyBit[ch - 'A'];
+        tiles_[idx] = bit == -1 ? TILE_WALL : static_cast<uint8_t>(TILE_DOOR | bit);
+        if (bit == -1) openCells_--;
+    }
+}
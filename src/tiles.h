@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <memory_resource>
+#include "grid.h"
+#include "level_index.h"
+
+// Tile classes stored per cell in a TileMap. Floor tiles (including 'S',
+// 'E' and letters outside the key alphabet) are 0; key and door tiles also
+// carry the compact bit of their key in the low bits.
+const uint8_t TILE_FLOOR = 0;
+const uint8_t TILE_WALL = 0x80;
+const uint8_t TILE_DOOR = 0x40;
+const uint8_t TILE_KEY = 0x20;
+const uint8_t TILE_BIT_MASK = 0x1F;
+
+// Doors of the basic rules (bfsPath and every engine without keys): 'A'-'F',
+// the doors of the default 'a'-'f' alphabet, except 'E', which is the exit.
+// They never open, so they block like walls.
+inline bool isDoorTile(char ch) { return ch >= 'A' && ch <= 'F' && ch != 'E'; }
+inline bool blocksWithoutKeys(char ch) { return ch == '#' || isDoorTile(ch); }
+
+/**
+ * Compile-time description of a key alphabet of NumKeys keys: keys are
+ * 'a', 'b', ... and the matching doors 'A', 'B', ... Mask is the smallest
+ * unsigned type that holds one bit per key.
+ *
+ * With more than 4 keys the door range covers 'E', and with more than 18
+ * it covers 'S'; those tiles always mean exit / start, so doors 'E' and 'S'
+ * cannot be used.
+ */
+template <int NumKeys>
+struct KeyAlphabet {
+    static_assert(NumKeys >= 1 && NumKeys <= 26, "key alphabet must be 1-26 keys");
+    using Mask = typename std::conditional<NumKeys <= 8, uint8_t,
+                 typename std::conditional<NumKeys <= 16, uint16_t, uint32_t>::type>::type;
+};
+
+/**
+ * Search state for key-door BFS: a cell (linear grid index) plus the
+ * bitmask of keys collected so far, in compact key bits (see TileMap).
+ */
+template <int NumKeys>
+struct State {
+    int cell;
+    typename KeyAlphabet<NumKeys>::Mask keys;
+};
+
+/**
+ * Per-cell tile-class table built in one pass over a Grid, so the key-door
+ * search classifies a neighbor with a single byte lookup.
+ *
+ * Keys are renumbered to compact bits in order of first appearance, so a
+ * dungeon using only keys 'b' and 'f' needs 2 bits (4 key layers), not 6.
+ * A door whose key does not appear anywhere can never open and is stored
+ * as a wall.
+ */
+class TileMap {
+public:
+    /**
+     * @param dungeon The dungeon grid to classify
+     * @param alphabetSize Number of key letters recognized ('a' onward)
+     * @param resource Memory resource for the tile table
+     */
+    TileMap(const Grid& dungeon, int alphabetSize,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * Classifies from an existing index of the dungeon, so only the wall
+     * test is made per tile and keys and doors come from its lists.
+     *
+     * @param dungeon The dungeon grid to classify
+     * @param index indexLevel of dungeon
+     * @param alphabetSize Number of key letters recognized ('a' onward)
+     * @param resource Memory resource for the tile table
+     */
+    TileMap(const Grid& dungeon, const LevelIndex& index, int alphabetSize,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    TileMap() = default;
+
+    /**
+     * Reclassifies for another dungeon, reusing the existing buffers.
+     *
+     * @param dungeon The dungeon grid to classify
+     * @param alphabetSize Number of key letters recognized ('a' onward)
+     */
+    void assign(const Grid& dungeon, int alphabetSize);
+    void assign(const Grid& dungeon, const LevelIndex& index, int alphabetSize);
+
+    uint8_t operator[](int idx) const { return tiles_[idx]; }
+
+    // Number of distinct keys present, i.e. compact key bits in use
+    int numKeys() const { return numKeys_; }
+
+    // Key-layer count of the state space: 2^numKeys()
+    uint64_t numLayers() const { return uint64_t(1) << numKeys_; }
+
+    // Original key letter of a compact key bit
+    char keyLetter(int bit) const { return letters_[bit]; }
+
+    // Number of non-wall tiles
+    int openCells() const { return openCells_; }
+
+    // Number of key tiles of the alphabet (a letter may appear many times)
+    int keyTiles() const { return keyTiles_; }
+
+private:
+    std::pmr::vector<uint8_t> tiles_;
+    LevelIndex index_;  // scratch for assign() without an index
+    int numKeys_ = 0;
+    int openCells_ = 0;
+    int keyTiles_ = 0;
+    char letters_[26] = {};
+};